@@ -0,0 +1,223 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief Memory resource that hands out memory by bumping a pointer through
+ * large blocks and frees nothing until release() or reset().
+ *
+ * Meant for data that is built once and dropped as a whole, such as a mesh
+ * and the indexes over it: allocation is a few instructions, related objects
+ * end up next to each other, and dropping everything returns a handful of
+ * blocks to the upstream resource instead of one free per object. Objects
+ * allocated from the arena must be destroyed before it is released. Not
+ * thread-safe.
+ */
+class MonotonicArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @param initial_block_size Size of the first block; later ones double
+     * @param upstream Where the blocks come from
+     */
+    explicit MonotonicArena(size_t initial_block_size = 64 * 1024,
+                            std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : initial_block_size_(std::max<size_t>(initial_block_size, 64)),
+          next_block_size_(initial_block_size_),
+          upstream_(upstream) {}
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() override { release(); }
+
+    /**
+     * @brief Returns all blocks to the upstream resource.
+     */
+    void release() {
+        for (const Block& block : blocks_) {
+            upstream_->deallocate(block.memory, block.size, alignof(std::max_align_t));
+        }
+        blocks_.clear();
+        cursor_ = end_ = nullptr;
+        bytes_allocated_ = 0;
+        next_block_size_ = initial_block_size_;
+    }
+
+    /**
+     * @brief Frees everything allocated but keeps the largest block, so that
+     * building a similar object again needs no upstream allocation.
+     */
+    void reset() {
+        if (blocks_.empty()) return;
+        auto largest = std::max_element(blocks_.begin(), blocks_.end(),
+                                        [](const Block& a, const Block& b) { return a.size < b.size; });
+        std::swap(*largest, blocks_.front());
+        for (size_t i = 1; i < blocks_.size(); ++i) {
+            upstream_->deallocate(blocks_[i].memory, blocks_[i].size, alignof(std::max_align_t));
+        }
+        blocks_.resize(1);
+        cursor_ = static_cast<char*>(blocks_.front().memory);
+        end_ = cursor_ + blocks_.front().size;
+        bytes_allocated_ = 0;
+    }
+
+    // Bytes handed out since the last release() or reset().
+    size_t bytes_allocated() const { return bytes_allocated_; }
+
+    // Bytes held in blocks.
+    size_t bytes_reserved() const {
+        size_t total = 0;
+        for (const Block& block : blocks_) {
+            total += block.size;
+        }
+        return total;
+    }
+
+private:
+    struct Block {
+        void* memory;
+        size_t size;
+    };
+
+    size_t initial_block_size_;
+    size_t next_block_size_;
+    std::pmr::memory_resource* upstream_;
+    std::vector<Block> blocks_;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t bytes_allocated_ = 0;
+
+    static char* align_up(char* p, size_t alignment) {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+        return p + ((alignment - address % alignment) % alignment);
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        char* p = cursor_ == nullptr ? nullptr : align_up(cursor_, alignment);
+        if (p == nullptr || bytes > static_cast<size_t>(end_ - p)) {
+            const size_t size = std::max(next_block_size_, bytes + alignment);
+            next_block_size_ = std::min<size_t>(2 * next_block_size_, size_t{1} << 30);
+            blocks_.push_back(Block{upstream_->allocate(size, alignof(std::max_align_t)), size});
+            cursor_ = static_cast<char*>(blocks_.back().memory);
+            end_ = cursor_ + size;
+            p = align_up(cursor_, alignment);
+        }
+        cursor_ = p + bytes;
+        bytes_allocated_ += bytes;
+        return p;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+/**
+ * @brief Memory resource for many objects of one size, such as tree or hash
+ * table nodes, that come and go.
+ *
+ * Blocks of the pool's size are carved from large chunks and recycled through
+ * a free list, so allocating and freeing a node never reaches the upstream
+ * resource once the pool is warm, and nodes do not fragment the heap. Larger
+ * or over-aligned requests are passed upstream. Dropping the pool returns all
+ * chunks at once. Not thread-safe.
+ */
+class FixedSizePool : public std::pmr::memory_resource {
+public:
+    /**
+     * @param block_size Largest request served from the pool
+     * @param blocks_per_chunk Number of blocks per upstream allocation
+     * @param upstream Where chunks and oversized requests go
+     */
+    explicit FixedSizePool(size_t block_size, size_t blocks_per_chunk = 1024,
+                           std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : block_size_(round_up(std::max(block_size, sizeof(FreeBlock)), alignof(std::max_align_t))),
+          blocks_per_chunk_(std::max<size_t>(blocks_per_chunk, 1)),
+          upstream_(upstream) {}
+
+    FixedSizePool(const FixedSizePool&) = delete;
+    FixedSizePool& operator=(const FixedSizePool&) = delete;
+
+    ~FixedSizePool() override { release(); }
+
+    size_t block_size() const { return block_size_; }
+
+    // Blocks currently handed out.
+    size_t blocks_in_use() const { return blocks_in_use_; }
+
+    /**
+     * @brief Returns all chunks to the upstream resource. Blocks still in use
+     * become invalid; oversized allocations are not affected.
+     */
+    void release() {
+        for (void* chunk : chunks_) {
+            upstream_->deallocate(chunk, block_size_ * blocks_per_chunk_, alignof(std::max_align_t));
+        }
+        chunks_.clear();
+        free_ = nullptr;
+        cursor_ = end_ = nullptr;
+        blocks_in_use_ = 0;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t block_size_;
+    size_t blocks_per_chunk_;
+    std::pmr::memory_resource* upstream_;
+    std::vector<void*> chunks_;
+    FreeBlock* free_ = nullptr;
+    // Part of the newest chunk not handed out yet.
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t blocks_in_use_ = 0;
+
+    static size_t round_up(size_t n, size_t multiple) { return (n + multiple - 1) / multiple * multiple; }
+
+    bool pooled(size_t bytes, size_t alignment) const {
+        return bytes <= block_size_ && alignment <= alignof(std::max_align_t);
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (!pooled(bytes, alignment)) return upstream_->allocate(bytes, alignment);
+        ++blocks_in_use_;
+        if (free_ != nullptr) {
+            FreeBlock* block = free_;
+            free_ = block->next;
+            return block;
+        }
+        if (cursor_ == end_) {
+            const size_t size = block_size_ * blocks_per_chunk_;
+            chunks_.push_back(upstream_->allocate(size, alignof(std::max_align_t)));
+            cursor_ = static_cast<char*>(chunks_.back());
+            end_ = cursor_ + size;
+        }
+        void* block = cursor_;
+        cursor_ += block_size_;
+        return block;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (!pooled(bytes, alignment)) {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+        --blocks_in_use_;
+        free_ = new (p) FreeBlock{free_};
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+} // namespace geometry
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "arena.hh"
+#include "benchmark_timing.hh"
+#include "dynamic_aabb_tree.hh"
+#include "kd_tree.hh"
+#include "surface.hh"
+#include "test_meshes.hh"
+#include "voxel_grid.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Arena alignment, reset and release
+    MonotonicArena arena(1024);
+    bool aligned = true;
+    for (size_t alignment : {1, 2, 4, 8, 16, 32, 64}) {
+        for (int i = 0; i < 100; ++i) {
+            void* p = arena.allocate(3 * alignment + 1, alignment);
+            aligned = aligned && reinterpret_cast<uintptr_t>(p) % alignment == 0;
+        }
+    }
+    std::cout << "Test 1 - Monotonic arena:" << std::endl;
+    std::cout << "Allocations aligned? " << (aligned ? "Yes" : "No") << std::endl;
+    size_t reserved = arena.bytes_reserved();
+    std::cout << "Reserved covers allocated? " << (reserved >= arena.bytes_allocated() ? "Yes" : "No") << std::endl;
+    arena.reset();
+    std::cout << "Reset keeps one block? " << (arena.bytes_reserved() > 0 && arena.bytes_reserved() <= reserved ? "Yes" : "No")
+              << std::endl;
+    arena.release();
+    std::cout << "Release frees everything? " << (arena.bytes_reserved() == 0 ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: Pool blocks are recycled, large requests pass through
+    FixedSizePool pool(48, 64);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 200; ++i) {
+        blocks.push_back(pool.allocate(40, 8));
+    }
+    void* last = blocks.back();
+    pool.deallocate(last, 40, 8);
+    bool recycled = pool.allocate(40, 8) == last;
+    void* large = pool.allocate(4096, 8);
+    bool passed_through = pool.blocks_in_use() == 200;
+    pool.deallocate(large, 4096, 8);
+    std::cout << "Test 2 - Fixed-size pool:" << std::endl;
+    std::cout << "Block size: " << pool.block_size() << std::endl;
+    std::cout << "Freed block reused? " << (recycled ? "Yes" : "No") << std::endl;
+    std::cout << "Large request passed upstream? " << (passed_through ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: A mesh and its voxel grid in an arena and a pool, against
+    // the default heap
+    std::mt19937 rng(39);
+    std::uniform_real_distribution<double> coordinate(-1, 1);
+    std::vector<LineSegment<double, 3>> segments(20000);
+    for (auto& s : segments) {
+        Point<double, 3> start(coordinate(rng), coordinate(rng), coordinate(rng));
+        Point<double, 3> step(coordinate(rng), coordinate(rng), coordinate(rng));
+        s = LineSegment<double, 3>(start, start + step * 0.2);
+    }
+    MonotonicArena mesh_arena;
+    FixedSizePool bricks(128, 1024, &mesh_arena);
+    Surface<double, 3> pooled_ball = triangulated_sphere(Point<double, 3>(0, 0, 0), 0.8, 60, 120, &mesh_arena);
+    VoxelGrid<double> pooled_grid(pooled_ball, 0.02, 1, &bricks);
+    Surface<double, 3> heap_ball =
+            triangulated_sphere(Point<double, 3>(0, 0, 0), 0.8, 60, 120, std::pmr::get_default_resource());
+    VoxelGrid<double> heap_grid(heap_ball, 0.02, 1);
+    std::cout << "Test 3 - Voxel grid in an arena:" << std::endl;
+    std::cout << pooled_ball << ", " << pooled_grid.num_bricks() << " bricks" << std::endl;
+    std::cout << "One pool block per brick? " << (bricks.blocks_in_use() == pooled_grid.num_bricks() ? "Yes" : "No")
+              << std::endl;
+    std::cout << "Matches the heap grid? "
+              << (pooled_grid.do_intersect(segments, 2) == heap_grid.do_intersect(segments, 2) ? "Yes" : "No")
+              << std::endl;
+    std::cout << std::endl;
+
+    // Test case 4: Dynamic tree churn with its node pool in an arena
+    MonotonicArena tree_arena;
+    DynamicAabbTree<double, 2> arena_tree(0.1, 2, &tree_arena);
+    DynamicAabbTree<double, 2> heap_tree;
+    std::vector<int32_t> arena_proxies, heap_proxies;
+    for (int i = 0; i < 20000; ++i) {
+        Point<double, 2> a(coordinate(rng), coordinate(rng));
+        LineSegment<double, 2> segment(a, a + Point<double, 2>(coordinate(rng), coordinate(rng)) * 0.01);
+        arena_proxies.push_back(arena_tree.insert(segment));
+        heap_proxies.push_back(heap_tree.insert(segment));
+        if (i % 3 == 2) {
+            arena_tree.remove(arena_proxies[i - 1]);
+            heap_tree.remove(heap_proxies[i - 1]);
+        }
+    }
+    std::cout << "Test 4 - Dynamic tree in an arena:" << std::endl;
+    std::cout << "Matches the heap tree? "
+              << (arena_tree.overlapping_pairs(arena_tree, 1) == heap_tree.overlapping_pairs(heap_tree, 1) ? "Yes" : "No")
+              << std::endl;
+    std::cout << std::endl;
+
+    // Test case 5: Building and dropping many small meshes and trees
+    std::vector<Point<double, 3>> points(2000);
+    for (auto& p : points) {
+        p = Point<double, 3>(coordinate(rng), coordinate(rng), coordinate(rng));
+    }
+    auto churn = [&](std::pmr::memory_resource* resource, MonotonicArena* reset) {
+        auto start = std::chrono::steady_clock::now();
+        size_t facets = 0;
+        for (int round = 0; round < 2000; ++round) {
+            {
+                Surface<double, 3> ball = triangulated_sphere(Point<double, 3>(0, 0, 0), 1.0, 8, 16, resource);
+                KdTree<double, 3> tree(points, 1, 16, resource);
+                facets += ball.num_facets() + tree.num_nodes();
+            }
+            if (reset != nullptr) reset->reset();
+        }
+        return std::make_pair(seconds_since(start), facets);
+    };
+    auto heap = churn(std::pmr::get_default_resource(), nullptr);
+    MonotonicArena churn_arena;
+    auto arena_run = churn(&churn_arena, &churn_arena);
+    std::cout << "Test 5 - Mesh churn:" << std::endl;
+    std::cout << "Heap: " << heap.first << " s, arena: " << arena_run.first << " s" << std::endl;
+    std::cout << "Same work? " << (heap.second == arena_run.second ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
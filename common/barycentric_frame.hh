@@ -0,0 +1,172 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "common/point.hh"
+
+namespace geometry {
+
+/**
+ * @brief Precomputed barycentric coordinate system of a simplex with N
+ * vertices in Dim-dimensional space (N - 1 <= Dim).
+ *
+ * With origin v0 and edge matrix E = [v1 - v0, ..., v(N-1) - v0], the
+ * coordinates of p are l = E^+ (p - v0) and l0 = 1 - sum(l). The (N-1) x Dim
+ * matrix E^+ (the inverse of E when the simplex is full-dimensional, e.g. a
+ * triangle in 2D or a tetrahedron in 3D, and its pseudo-inverse otherwise, e.g.
+ * a triangle in 3D) is computed once, so each query is a small matrix-vector
+ * product.
+ */
+template <typename T, size_t Dim, size_t N>
+class BarycentricFrame {
+    static_assert(N >= 2 && N - 1 <= Dim, "A frame needs 2 to Dim + 1 vertices");
+
+public:
+    static constexpr size_t kEdges = N - 1;
+
+    BarycentricFrame() = default;
+
+    /**
+     * @brief Builds the frame of a simplex.
+     * @param vertices The N vertices of the simplex
+     * @throws std::invalid_argument if the simplex is degenerate
+     */
+    explicit BarycentricFrame(const std::array<Point<T, Dim>, N>& vertices): origin_(vertices[0]) {
+        // edges[j] = v(j+1) - v0
+        std::array<Point<T, Dim>, kEdges> edges;
+        for (size_t j = 0; j < kEdges; ++j) {
+            edges[j] = vertices[j + 1] - vertices[0];
+        }
+
+        if constexpr (kEdges == Dim) {
+            // Square: E^+ = E^-1.
+            std::array<std::array<T, Dim>, Dim> matrix;
+            for (size_t r = 0; r < Dim; ++r) {
+                for (size_t c = 0; c < Dim; ++c) {
+                    matrix[r][c] = edges[c][r];
+                }
+            }
+            inverse_ = invert(matrix);
+        } else {
+            // Embedded: E^+ = (E^T E)^-1 E^T.
+            std::array<std::array<T, kEdges>, kEdges> gram;
+            for (size_t r = 0; r < kEdges; ++r) {
+                for (size_t c = 0; c < kEdges; ++c) {
+                    gram[r][c] = dot_product(edges[r], edges[c]);
+                }
+            }
+            std::array<std::array<T, kEdges>, kEdges> gram_inverse = invert(gram);
+            for (size_t r = 0; r < kEdges; ++r) {
+                for (size_t c = 0; c < Dim; ++c) {
+                    T sum{};
+                    for (size_t k = 0; k < kEdges; ++k) {
+                        sum += gram_inverse[r][k] * edges[k][c];
+                    }
+                    inverse_[r][c] = sum;
+                }
+            }
+            edges_ = edges;
+        }
+    }
+
+    /**
+     * @brief Calculates the barycentric coordinates of a point.
+     * For an embedded simplex, these are the coordinates of the point's
+     * orthogonal projection onto the simplex's affine hull.
+     * @param p The point
+     * @return The N coordinates, summing to 1
+     */
+    std::array<T, N> coordinates(const Point<T, Dim>& p) const {
+        Point<T, Dim> offset = p - origin_;
+        std::array<T, N> lambda;
+        T sum{};
+        for (size_t r = 0; r < kEdges; ++r) {
+            T value{};
+            for (size_t c = 0; c < Dim; ++c) {
+                value += inverse_[r][c] * offset[c];
+            }
+            lambda[r + 1] = value;
+            sum += value;
+        }
+        lambda[0] = T(1) - sum;
+        return lambda;
+    }
+
+    /**
+     * @brief Checks if a point lies in the simplex (within tolerance).
+     * For an embedded simplex the point must also lie within tolerance of its
+     * affine hull.
+     * @param p The point to check
+     * @param tolerance Allowed negative barycentric coordinate / distance
+     * @return true if the point is in the simplex
+     */
+    bool contains(const Point<T, Dim>& p, T tolerance = 1e-9) const {
+        std::array<T, N> lambda = coordinates(p);
+        for (size_t i = 0; i < N; ++i) {
+            if (lambda[i] < -tolerance) return false;
+        }
+        if constexpr (kEdges < Dim) {
+            Point<T, Dim> residual = p - origin_;
+            for (size_t j = 0; j < kEdges; ++j) {
+                residual -= edges_[j] * lambda[j + 1];
+            }
+            if (squared_norm(residual) > tolerance * tolerance) return false;
+        }
+        return true;
+    }
+
+private:
+    Point<T, Dim> origin_;
+    std::array<std::array<T, Dim>, kEdges> inverse_{};
+    // Only needed for the off-hull distance of embedded simplices.
+    std::array<Point<T, Dim>, (kEdges < Dim ? kEdges : 0)> edges_{};
+
+    // Gauss-Jordan elimination with partial pivoting.
+    template <size_t M>
+    static std::array<std::array<T, M>, M> invert(std::array<std::array<T, M>, M> a) {
+        std::array<std::array<T, M>, M> result{};
+        T scale{};
+        for (size_t r = 0; r < M; ++r) {
+            result[r][r] = T(1);
+            for (size_t c = 0; c < M; ++c) {
+                scale = std::max(scale, std::abs(a[r][c]));
+            }
+        }
+        const T threshold = scale * M * std::numeric_limits<T>::epsilon();
+
+        for (size_t col = 0; col < M; ++col) {
+            size_t pivot = col;
+            for (size_t r = col + 1; r < M; ++r) {
+                if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+            }
+            if (!(std::abs(a[pivot][col]) > threshold)) {
+                throw std::invalid_argument("Cannot build a barycentric frame of a degenerate simplex");
+            }
+            std::swap(a[col], a[pivot]);
+            std::swap(result[col], result[pivot]);
+
+            T inverse_pivot = T(1) / a[col][col];
+            for (size_t c = 0; c < M; ++c) {
+                a[col][c] *= inverse_pivot;
+                result[col][c] *= inverse_pivot;
+            }
+            for (size_t r = 0; r < M; ++r) {
+                if (r == col) continue;
+                T factor = a[r][col];
+                for (size_t c = 0; c < M; ++c) {
+                    a[r][c] -= factor * a[col][c];
+                    result[r][c] -= factor * result[col][c];
+                }
+            }
+        }
+        return result;
+    }
+};
+
+} // namespace geometry
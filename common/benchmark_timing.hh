@@ -0,0 +1,35 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace geometry {
+
+/**
+ * @brief Wall-clock time elapsed since a point, for tests and benchmarks.
+ * @param start The start time
+ * @return The elapsed time in seconds
+ */
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Calls fn(threads) for 1, 2, 4, ... threads below max_threads and
+ * then once for max_threads, which need not be a power of two.
+ * @param max_threads The largest thread count; 0 is taken as 1
+ * @param fn The benchmark step
+ */
+template <typename Fn>
+void for_each_thread_count(size_t max_threads, Fn&& fn) {
+    max_threads = std::max<size_t>(1, max_threads);
+    for (size_t threads = 1;; threads = std::min(2 * threads, max_threads)) {
+        fn(threads);
+        if (threads == max_threads) break;
+    }
+}
+
+} // namespace geometry
@@ -0,0 +1,141 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+#include "common/point.hh"
+
+namespace geometry {
+
+/**
+ * @brief Axis-aligned bounding box in Dim-dimensional space.
+ * A default-constructed box is empty (min > max) and absorbs the first point
+ * or box it is expanded with.
+ */
+template <typename T, size_t Dim>
+class BoundingBox {
+public:
+    constexpr BoundingBox() {
+        for (size_t i = 0; i < Dim; ++i) {
+            min_[i] = std::numeric_limits<T>::max();
+            max_[i] = std::numeric_limits<T>::lowest();
+        }
+    }
+
+    constexpr BoundingBox(const Point<T, Dim>& min, const Point<T, Dim>& max): min_(min), max_(max) {}
+
+    constexpr const Point<T, Dim>& min() const { return min_; }
+    constexpr const Point<T, Dim>& max() const { return max_; }
+
+    constexpr bool is_empty() const {
+        for (size_t i = 0; i < Dim; ++i) {
+            if (min_[i] > max_[i]) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Grows the box to contain a point.
+     */
+    constexpr void expand(const Point<T, Dim>& p) {
+        for (size_t i = 0; i < Dim; ++i) {
+            min_[i] = std::min(min_[i], p[i]);
+            max_[i] = std::max(max_[i], p[i]);
+        }
+    }
+
+    /**
+     * @brief Grows the box to contain another box.
+     */
+    constexpr void expand(const BoundingBox& other) {
+        for (size_t i = 0; i < Dim; ++i) {
+            min_[i] = std::min(min_[i], other.min_[i]);
+            max_[i] = std::max(max_[i], other.max_[i]);
+        }
+    }
+
+    /**
+     * @brief Grows the box by margin on every side.
+     */
+    constexpr void inflate(T margin) {
+        for (size_t i = 0; i < Dim; ++i) {
+            min_[i] -= margin;
+            max_[i] += margin;
+        }
+    }
+
+    constexpr bool contains(const Point<T, Dim>& p) const {
+        for (size_t i = 0; i < Dim; ++i) {
+            if (p[i] < min_[i] || p[i] > max_[i]) return false;
+        }
+        return true;
+    }
+
+    constexpr bool contains(const BoundingBox& other) const {
+        for (size_t i = 0; i < Dim; ++i) {
+            if (other.min_[i] < min_[i] || other.max_[i] > max_[i]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks if two boxes overlap (touching counts as overlap).
+     */
+    constexpr bool intersects(const BoundingBox& other) const {
+        for (size_t i = 0; i < Dim; ++i) {
+            if (other.max_[i] < min_[i] || other.min_[i] > max_[i]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Squared distance from a point to the box (0 inside the box).
+     */
+    constexpr T squared_distance(const Point<T, Dim>& p) const {
+        T sum{};
+        for (size_t i = 0; i < Dim; ++i) {
+            T d{};
+            if (p[i] < min_[i]) d = min_[i] - p[i];
+            else if (p[i] > max_[i]) d = p[i] - max_[i];
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    constexpr T extent(size_t dim) const { return max_[dim] - min_[dim]; }
+
+    /**
+     * @brief Dimension along which the box is widest.
+     */
+    constexpr size_t longest_axis() const {
+        size_t axis = 0;
+        for (size_t i = 1; i < Dim; ++i) {
+            if (extent(i) > extent(axis)) axis = i;
+        }
+        return axis;
+    }
+
+    constexpr Point<T, Dim> center() const {
+        Point<T, Dim> c = min_ + max_;
+        for (size_t i = 0; i < Dim; ++i) {
+            c[i] /= 2;
+        }
+        return c;
+    }
+
+private:
+    Point<T, Dim> min_;
+    Point<T, Dim> max_;
+};
+
+// Overload the << operator for easy printing
+template <typename T, size_t Dim>
+std::ostream& operator<<(std::ostream& os, const BoundingBox<T, Dim>& box) {
+    os << "[" << box.min() << " - " << box.max() << "]";
+    return os;
+}
+
+} // namespace geometry
@@ -0,0 +1,373 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "common/line_segment_intersection.hh"
+#include "common/point.hh"
+#include "common/simplex.hh"
+#include "common/surface.hh"
+#include "common/thread_pool.hh"
+
+namespace geometry {
+
+// orientation(p1, p2, p3) returns 2 when p3 is left of the directed line
+// p1 -> p2 (with y pointing up), which is the turn a counterclockwise hull
+// makes at every vertex.
+constexpr int kLeftTurn = 2;
+
+/**
+ * @brief Andrew's monotone chain over points sorted by (x, y).
+ * @param sorted The points, sorted lexicographically
+ * @return The hull vertices in counterclockwise order, starting with the lowest
+ *         (x, y), without collinear points
+ */
+template <typename T>
+std::vector<Point<T, 2>> monotone_chain(const std::vector<Point<T, 2>>& sorted) {
+    std::vector<Point<T, 2>> hull;
+    if (sorted.size() < 2) return sorted;
+    hull.reserve(2 * sorted.size());
+
+    // Lower hull left to right, then upper hull right to left.
+    for (const Point<T, 2>& p : sorted) {
+        while (hull.size() >= 2 && orientation(hull[hull.size() - 2], hull.back(), p) != kLeftTurn) {
+            hull.pop_back();
+        }
+        hull.push_back(p);
+    }
+    const size_t lower_size = hull.size();
+    for (size_t i = sorted.size() - 1; i-- > 0;) {
+        while (hull.size() > lower_size && orientation(hull[hull.size() - 2], hull.back(), sorted[i]) != kLeftTurn) {
+            hull.pop_back();
+        }
+        hull.push_back(sorted[i]);
+    }
+    // The last point is the first one again; all points equal leaves [p, p].
+    hull.pop_back();
+    if (hull.size() == 2 && hull[0] == hull[1]) hull.pop_back();
+    return hull;
+}
+
+/**
+ * @brief Calculates the convex hull of a set of 2D points.
+ *
+ * An Akl-Toussaint filter first discards the points strictly inside the
+ * octagon spanned by the extreme points in the directions x, y, x + y and
+ * x - y, which for most inputs leaves a small fraction. Each thread then sorts
+ * its share of the survivors and builds their hull with the monotone chain;
+ * the partial hulls are merged by one more monotone chain over their vertices.
+ *
+ * @param points The points
+ * @param executor Pool and number of threads
+ * @return The hull vertices in counterclockwise order, starting with the lowest
+ *         (x, y), without collinear points
+ */
+template <typename T>
+std::vector<Point<T, 2>> convex_hull(const std::vector<Point<T, 2>>& points,
+                                     Executor executor = Executor()) {
+    const size_t n = points.size();
+    const size_t num_threads = std::max<size_t>(1, std::min(executor.num_threads(), n));
+    size_t chunk = n == 0 ? 0 : (n + num_threads - 1) / num_threads;
+    auto run_chunks = [&](auto fn) {
+        executor.pool().run(num_threads, [&](size_t t) {
+            fn(t, std::min(n, t * chunk), std::min(n, (t + 1) * chunk));
+        });
+    };
+
+    // Extreme points, in counterclockwise order of their directions: min y,
+    // max x - y, max x, max x + y, max y, min x - y, min x, min x + y.
+    constexpr size_t kDirections = 8;
+    auto key = [](const Point<T, 2>& p, size_t direction) {
+        switch (direction) {
+            case 0: return -p.y();
+            case 1: return p.x() - p.y();
+            case 2: return p.x();
+            case 3: return p.x() + p.y();
+            case 4: return p.y();
+            case 5: return p.y() - p.x();
+            case 6: return -p.x();
+            default: return -p.x() - p.y();
+        }
+    };
+    std::vector<std::array<uint32_t, kDirections>> extremes(num_threads);
+    run_chunks([&](size_t t, size_t begin, size_t end) {
+        extremes[t].fill(static_cast<uint32_t>(begin < end ? begin : 0));
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t d = 0; d < kDirections; ++d) {
+                if (key(points[i], d) > key(points[extremes[t][d]], d)) extremes[t][d] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+    std::vector<Point<T, 2>> octagon;
+    for (size_t d = 0; d < kDirections && n > 0; ++d) {
+        uint32_t best = extremes[0][d];
+        for (size_t t = 1; t < num_threads; ++t) {
+            if (key(points[extremes[t][d]], d) > key(points[best], d)) best = extremes[t][d];
+        }
+        if (octagon.empty() || !(points[best] == octagon.back())) octagon.push_back(points[best]);
+    }
+    while (octagon.size() > 1 && octagon.front() == octagon.back()) {
+        octagon.pop_back();
+    }
+
+    // Filter, sort and hull each chunk.
+    auto strictly_inside = [&](const Point<T, 2>& p) {
+        if (octagon.size() < 3) return false;
+        for (size_t i = 0; i < octagon.size(); ++i) {
+            if (orientation(octagon[i], octagon[(i + 1) % octagon.size()], p) != kLeftTurn) return false;
+        }
+        return true;
+    };
+    auto lexicographic = [](const Point<T, 2>& a, const Point<T, 2>& b) {
+        return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+    };
+    std::vector<std::vector<Point<T, 2>>> partial(num_threads);
+    run_chunks([&](size_t t, size_t begin, size_t end) {
+        std::vector<Point<T, 2>> survivors;
+        for (size_t i = begin; i < end; ++i) {
+            if (!strictly_inside(points[i])) survivors.push_back(points[i]);
+        }
+        std::sort(survivors.begin(), survivors.end(), lexicographic);
+        partial[t] = monotone_chain(survivors);
+    });
+
+    std::vector<Point<T, 2>> merged;
+    for (const auto& hull : partial) {
+        merged.insert(merged.end(), hull.begin(), hull.end());
+    }
+    std::sort(merged.begin(), merged.end(), lexicographic);
+    return monotone_chain(merged);
+}
+
+/**
+ * @brief Calculates the convex hull of a set of 3D points with QuickHull.
+ *
+ * The initial tetrahedron is spanned by extreme points along the axes and
+ * the diagonals; every point inside it is discarded while the remaining
+ * points are assigned, in parallel, to a face they lie above. The hull then
+ * grows one point at a time: the farthest point above a face removes every
+ * face it can see and is joined to the horizon of those faces, and the points
+ * of the removed faces move to the new faces or are discarded.
+ *
+ * @param points The points
+ * @param executor Pool and number of threads for the initial partition
+ * @return The hull as triangles with counterclockwise vertices seen from outside
+ * @throws std::invalid_argument if the points are all coplanar
+ */
+template <typename T>
+Surface<T, 3> convex_hull(const std::vector<Point<T, 3>>& points,
+                          Executor executor = Executor()) {
+    using Vertex = uint32_t;
+    const size_t n = points.size();
+    if (n < 4) {
+        throw std::invalid_argument("A 3D convex hull needs at least 4 points that are not coplanar");
+    }
+
+    struct Face {
+        std::array<Vertex, 3> vertices;
+        // neighbors[i] is across the edge vertices[i] -> vertices[i + 1].
+        std::array<uint32_t, 3> neighbors{};
+        Point<T, 3> normal;
+        T offset{};
+        std::vector<Vertex> outside;
+        bool alive = true;
+    };
+    std::vector<Face> faces;
+
+    // Scale-relative distance below which a point counts as on a plane.
+    T scale{};
+    for (const Point<T, 3>& p : points) {
+        scale = std::max({scale, std::abs(p[0]), std::abs(p[1]), std::abs(p[2])});
+    }
+    const T eps = 3 * 3 * scale * std::numeric_limits<T>::epsilon();
+
+    auto distance = [&](const Face& face, Vertex v) { return dot_product(face.normal, points[v]) - face.offset; };
+    auto make_face = [&](Vertex a, Vertex b, Vertex c) {
+        Face face;
+        face.vertices = {a, b, c};
+        Point<T, 3> normal = cross_product(points[b] - points[a], points[c] - points[a]);
+        face.normal = normal * (T(1) / norm(normal));
+        face.offset = dot_product(face.normal, points[a]);
+        faces.push_back(std::move(face));
+        return static_cast<uint32_t>(faces.size() - 1);
+    };
+
+    // Initial tetrahedron from the extremes along 7 directions.
+    const Point<T, 3> directions[7] = {Point<T, 3>(1, 0, 0),  Point<T, 3>(0, 1, 0),  Point<T, 3>(0, 0, 1),
+                                       Point<T, 3>(1, 1, 1),  Point<T, 3>(1, 1, -1), Point<T, 3>(1, -1, 1),
+                                       Point<T, 3>(-1, 1, 1)};
+    std::vector<Vertex> extremes;
+    for (const Point<T, 3>& direction : directions) {
+        Vertex low = 0, high = 0;
+        for (Vertex i = 1; i < n; ++i) {
+            T d = dot_product(direction, points[i]);
+            if (d < dot_product(direction, points[low])) low = i;
+            if (d > dot_product(direction, points[high])) high = i;
+        }
+        extremes.push_back(low);
+        extremes.push_back(high);
+    }
+    Vertex v0 = extremes[0], v1 = extremes[1];
+    for (Vertex a : extremes) {
+        for (Vertex b : extremes) {
+            if (squared_norm(points[b] - points[a]) > squared_norm(points[v1] - points[v0])) {
+                v0 = a;
+                v1 = b;
+            }
+        }
+    }
+    Vertex v2 = v0;
+    T best{};
+    for (Vertex i = 0; i < n; ++i) {
+        T d = squared_norm(cross_product(points[v1] - points[v0], points[i] - points[v0]));
+        if (d > best) {
+            best = d;
+            v2 = i;
+        }
+    }
+    if (!(std::sqrt(best) > eps * norm(points[v1] - points[v0]))) {
+        throw std::invalid_argument("A 3D convex hull needs at least 4 points that are not coplanar");
+    }
+    Point<T, 3> base_normal = cross_product(points[v1] - points[v0], points[v2] - points[v0]);
+    base_normal = base_normal * (T(1) / norm(base_normal));
+    Vertex v3 = v0;
+    best = 0;
+    for (Vertex i = 0; i < n; ++i) {
+        T d = std::abs(dot_product(base_normal, points[i] - points[v0]));
+        if (d > best) {
+            best = d;
+            v3 = i;
+        }
+    }
+    if (!(best > eps)) {
+        throw std::invalid_argument("A 3D convex hull needs at least 4 points that are not coplanar");
+    }
+    if (dot_product(base_normal, points[v3] - points[v0]) > 0) std::swap(v1, v2);
+
+    // Faces (v0, v1, v2) facing away from v3, and the three faces on v3.
+    make_face(v0, v1, v2);
+    make_face(v1, v0, v3);
+    make_face(v2, v1, v3);
+    make_face(v0, v2, v3);
+    faces[0].neighbors = {1, 2, 3};
+    faces[1].neighbors = {0, 3, 2};
+    faces[2].neighbors = {0, 1, 3};
+    faces[3].neighbors = {0, 2, 1};
+
+    // Partition the points among the four faces in parallel.
+    const size_t num_threads = std::max<size_t>(1, std::min(executor.num_threads(), n));
+    std::vector<std::array<std::vector<Vertex>, 4>> outside(num_threads);
+    auto partition = [&](size_t t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t f = 0; f < 4; ++f) {
+                if (distance(faces[f], static_cast<Vertex>(i)) > eps) {
+                    outside[t][f].push_back(static_cast<Vertex>(i));
+                    break;
+                }
+            }
+        }
+    };
+    size_t chunk = (n + num_threads - 1) / num_threads;
+    executor.pool().run(num_threads, [&](size_t t) {
+        partition(t, std::min(n, t * chunk), std::min(n, (t + 1) * chunk));
+    });
+    std::vector<uint32_t> pending;
+    for (size_t f = 0; f < 4; ++f) {
+        for (size_t t = 0; t < num_threads; ++t) {
+            faces[f].outside.insert(faces[f].outside.end(), outside[t][f].begin(), outside[t][f].end());
+        }
+        if (!faces[f].outside.empty()) pending.push_back(static_cast<uint32_t>(f));
+    }
+
+    std::vector<uint32_t> visited_in;
+    std::vector<uint8_t> visible;
+    uint32_t iteration = 0;
+    while (!pending.empty()) {
+        uint32_t start = pending.back();
+        pending.pop_back();
+        if (!faces[start].alive || faces[start].outside.empty()) continue;
+        ++iteration;
+
+        // The farthest point above the face.
+        Vertex eye = faces[start].outside[0];
+        for (Vertex v : faces[start].outside) {
+            if (distance(faces[start], v) > distance(faces[start], eye)) eye = v;
+        }
+
+        // Faces visible from the eye, found by flooding from start.
+        visited_in.resize(faces.size(), 0);
+        visible.resize(faces.size(), 0);
+        std::vector<uint32_t> removed{start};
+        visited_in[start] = iteration;
+        visible[start] = 1;
+        for (size_t k = 0; k < removed.size(); ++k) {
+            for (uint32_t neighbor : faces[removed[k]].neighbors) {
+                if (visited_in[neighbor] == iteration) continue;
+                visited_in[neighbor] = iteration;
+                visible[neighbor] = distance(faces[neighbor], eye) > eps;
+                if (visible[neighbor]) removed.push_back(neighbor);
+            }
+        }
+
+        // A cone of new faces from the eye over the horizon edges, linked to
+        // each other through the horizon vertices.
+        std::unordered_map<Vertex, uint32_t> starting_at, ending_at;
+        std::vector<uint32_t> created;
+        for (uint32_t f : removed) {
+            for (size_t i = 0; i < 3; ++i) {
+                uint32_t neighbor = faces[f].neighbors[i];
+                if (visible[neighbor] && visited_in[neighbor] == iteration) continue;
+                Vertex a = faces[f].vertices[i];
+                Vertex b = faces[f].vertices[(i + 1) % 3];
+                uint32_t face = make_face(a, b, eye);
+                faces[face].neighbors[0] = neighbor;
+                for (size_t j = 0; j < 3; ++j) {
+                    if (faces[neighbor].vertices[j] == b) faces[neighbor].neighbors[j] = face;
+                }
+                starting_at[a] = face;
+                ending_at[b] = face;
+                created.push_back(face);
+            }
+        }
+        for (uint32_t face : created) {
+            faces[face].neighbors[1] = starting_at[faces[face].vertices[1]];
+            faces[face].neighbors[2] = ending_at[faces[face].vertices[0]];
+        }
+
+        // Hand the removed faces' points to the new faces.
+        for (uint32_t f : removed) {
+            faces[f].alive = false;
+            std::vector<Vertex> orphans;
+            orphans.swap(faces[f].outside);
+            for (Vertex v : orphans) {
+                if (v == eye) continue;
+                for (uint32_t face : created) {
+                    if (distance(faces[face], v) > eps) {
+                        faces[face].outside.push_back(v);
+                        break;
+                    }
+                }
+            }
+        }
+        for (uint32_t face : created) {
+            if (!faces[face].outside.empty()) pending.push_back(face);
+        }
+    }
+
+    Surface<T, 3> hull;
+    for (const Face& face : faces) {
+        if (!face.alive) continue;
+        hull.add_facet(Simplex<T, 3>({points[face.vertices[0]], points[face.vertices[1]], points[face.vertices[2]]}));
+    }
+    return hull;
+}
+
+} // namespace geometry
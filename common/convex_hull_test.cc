@@ -0,0 +1,81 @@
+#include <iostream>
+#include <random>
+#include "convex_hull.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Square with interior, boundary and duplicate points
+    std::vector<Point<double, 2>> square = {
+        Point<double, 2>(0, 0), Point<double, 2>(2, 0), Point<double, 2>(2, 2), Point<double, 2>(0, 2),
+        Point<double, 2>(1, 1), Point<double, 2>(1, 0), Point<double, 2>(2, 2), Point<double, 2>(0.5, 1.5)};
+    std::vector<Point<double, 2>> hull = convex_hull(square, 2);
+    std::cout << "Test 1 - Square hull:";
+    for (const Point<double, 2>& p : hull) {
+        std::cout << " " << p;
+    }
+    std::cout << std::endl << std::endl;
+
+    // Test case 2: Random points; every point must be inside or on the hull
+    std::mt19937 rng(4);
+    std::normal_distribution<double> gaussian;
+    std::vector<Point<double, 2>> cloud(200000);
+    for (Point<double, 2>& p : cloud) {
+        p = Point<double, 2>(gaussian(rng), gaussian(rng));
+    }
+    std::vector<Point<double, 2>> cloud_hull = convex_hull(cloud, 4);
+    bool contains_all = true;
+    for (size_t i = 0; i < cloud_hull.size(); ++i) {
+        const Point<double, 2>& a = cloud_hull[i];
+        const Point<double, 2>& b = cloud_hull[(i + 1) % cloud_hull.size()];
+        for (const Point<double, 2>& p : cloud) {
+            if (orientation(a, b, p) == 1) contains_all = false;
+        }
+    }
+    std::cout << "Test 2 - Random 2D points:" << std::endl;
+    std::cout << "Hull of " << cloud.size() << " points has " << cloud_hull.size() << " vertices" << std::endl;
+    std::cout << "Same hull with 1 thread? " << (convex_hull(cloud, 1) == cloud_hull ? "Yes" : "No") << std::endl;
+    std::cout << "Contains all points? " << (contains_all ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: Cube corners plus interior points
+    std::vector<Point<double, 3>> cube;
+    for (int i = 0; i < 8; ++i) {
+        cube.emplace_back(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+    }
+    std::uniform_real_distribution<double> unit(0.01, 0.99);
+    for (int i = 0; i < 1000; ++i) {
+        cube.emplace_back(unit(rng), unit(rng), unit(rng));
+    }
+    Surface<double, 3> cube_hull = convex_hull(cube, 2);
+    std::cout << "Test 3 - Cube hull:" << std::endl;
+    std::cout << cube_hull << ", area " << cube_hull.area() << std::endl;
+    std::cout << std::endl;
+
+    // Test case 4: Points on a sphere; all must be on or inside every face
+    std::vector<Point<double, 3>> sphere(5000);
+    for (Point<double, 3>& p : sphere) {
+        Point<double, 3> d(gaussian(rng), gaussian(rng), gaussian(rng));
+        p = d * (1 / norm(d));
+    }
+    Surface<double, 3> sphere_hull = convex_hull(sphere, 4);
+    double farthest = 0;
+    for (const Simplex<double, 3>& facet : sphere_hull.facets) {
+        Point<double, 3> normal = cross_product(facet.vertices[1] - facet.vertices[0], facet.vertices[2] - facet.vertices[0]);
+        normal = normal * (1 / norm(normal));
+        for (const Point<double, 3>& p : sphere) {
+            farthest = std::max(farthest, dot_product(normal, p - facet.vertices[0]));
+        }
+    }
+    std::cout << "Test 4 - Random points on a sphere:" << std::endl;
+    std::cout << sphere_hull << " (Euler: " << (sphere_hull.num_facets() == 2 * sphere.size() - 4 ? "2V - 4" : "other") << ")" << std::endl;
+    std::cout << "Contains all points? " << (farthest < 1e-12 ? "Yes" : "No") << std::endl;
+    try {
+        convex_hull(std::vector<Point<double, 3>>{Point<double, 3>(0, 0, 0), Point<double, 3>(1, 0, 0),
+                                                   Point<double, 3>(0, 1, 0), Point<double, 3>(1, 1, 0)});
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Coplanar input: " << e.what() << std::endl;
+    }
+
+    return 0;
+}
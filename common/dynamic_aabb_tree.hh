@@ -0,0 +1,414 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "common/bounding_box.hh"
+#include "common/line_segment.hh"
+#include "common/point.hh"
+#include "common/thread_pool.hh"
+
+namespace geometry {
+
+/**
+ * @brief Bounding volume tree over a changing set of line segments.
+ *
+ * Each segment (a proxy) is a leaf whose box is its tight box grown by a
+ * margin, and along the last displacement when the caller provides one, so
+ * small motions do not touch the tree at all. Insertion descends to the
+ * sibling that least increases the summed box cost; after every insertion
+ * and removal the ancestors are rebalanced with AVL-style rotations, which
+ * keeps the height logarithmic. Nodes live in a pool with a free list, and a
+ * proxy id is the index of its leaf, stable until the proxy is removed.
+ */
+template <typename T, size_t Dim>
+class DynamicAabbTree {
+public:
+    static constexpr int32_t kNullNode = -1;
+
+    /**
+     * @param margin Amount by which leaf boxes are grown on every side
+     * @param displacement_factor Multiple of the displacement passed to insert() or update() by which leaf boxes are extended
+     * @param resource Where the node pool is allocated
+     */
+    explicit DynamicAabbTree(T margin = T(0.1), T displacement_factor = T(2),
+                             std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : margin_(margin), displacement_factor_(displacement_factor), nodes_(resource), segments_(resource) {}
+
+    size_t size() const { return num_proxies_; }
+
+    bool empty() const { return num_proxies_ == 0; }
+
+    // Height of the tree; a single leaf has height 0 and an empty tree -1.
+    int32_t height() const { return root_ == kNullNode ? -1 : nodes_[root_].height; }
+
+    const LineSegment<T, Dim>& segment(int32_t proxy) const { return segments_[proxy]; }
+
+    const BoundingBox<T, Dim>& fat_box(int32_t proxy) const { return nodes_[proxy].box; }
+
+    /**
+     * @brief Adds a segment.
+     * @param segment The segment
+     * @param displacement Expected motion until the next update, used to extend the box
+     * @return The proxy id of the segment
+     */
+    int32_t insert(const LineSegment<T, Dim>& segment, const Point<T, Dim>& displacement = Point<T, Dim>()) {
+        int32_t leaf = allocate_node();
+        nodes_[leaf].box = fatten(segment, displacement);
+        nodes_[leaf].height = 0;
+        segments_[leaf] = segment;
+        insert_leaf(leaf);
+        ++num_proxies_;
+        return leaf;
+    }
+
+    /**
+     * @brief Removes a segment.
+     * @param proxy The proxy id returned by insert()
+     * @throws std::invalid_argument if proxy is not a live proxy
+     */
+    void remove(int32_t proxy) {
+        check_proxy(proxy);
+        remove_leaf(proxy);
+        free_node(proxy);
+        --num_proxies_;
+    }
+
+    /**
+     * @brief Moves a segment. The tree only changes when the segment leaves
+     * its fattened box.
+     * @param proxy The proxy id returned by insert()
+     * @param segment The segment's new position
+     * @param displacement Expected motion until the next update, used to extend the box
+     * @return true if the leaf was reinserted
+     * @throws std::invalid_argument if proxy is not a live proxy
+     */
+    bool update(int32_t proxy, const LineSegment<T, Dim>& segment,
+                const Point<T, Dim>& displacement = Point<T, Dim>()) {
+        check_proxy(proxy);
+        segments_[proxy] = segment;
+        BoundingBox<T, Dim> tight;
+        tight.expand(segment.start());
+        tight.expand(segment.end());
+        if (nodes_[proxy].box.contains(tight)) return false;
+
+        remove_leaf(proxy);
+        nodes_[proxy].box = fatten(segment, displacement);
+        insert_leaf(proxy);
+        return true;
+    }
+
+    /**
+     * @brief Calls fn(proxy) for every proxy whose fattened box overlaps a
+     * box, until fn returns false.
+     */
+    template <typename Fn>
+    void query(const BoundingBox<T, Dim>& box, Fn fn) const {
+        if (root_ == kNullNode) return;
+        std::vector<int32_t> stack{root_};
+        while (!stack.empty()) {
+            int32_t index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes_[index];
+            if (!node.box.intersects(box)) continue;
+            if (node.is_leaf()) {
+                if (!fn(index)) return;
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    /**
+     * @brief Finds all pairs of proxies of this tree and another whose
+     * fattened boxes overlap, by traversing both trees simultaneously. The
+     * top of the traversal is expanded breadth-first into independent node
+     * pairs, which the threads then finish depth-first.
+     * @param other The other tree (may be this tree, which also reports each proxy with itself)
+     * @param executor Pool and number of threads
+     * @return Pairs (proxy of this tree, proxy of other), sorted
+     */
+    std::vector<std::pair<int32_t, int32_t>> overlapping_pairs(
+            const DynamicAabbTree& other, Executor executor = Executor()) const {
+        using NodePair = std::pair<int32_t, int32_t>;
+        std::vector<NodePair> result;
+        if (root_ == kNullNode || other.root_ == kNullNode) return result;
+
+        // Refines an overlapping pair of nodes into child pairs, or reports it
+        // if both are leaves.
+        auto refine = [&](NodePair pair, std::vector<NodePair>& pending, std::vector<NodePair>& found) {
+            const Node& a = nodes_[pair.first];
+            const Node& b = other.nodes_[pair.second];
+            if (!a.box.intersects(b.box)) return;
+            if (a.is_leaf() && b.is_leaf()) {
+                found.push_back(pair);
+            } else if (b.is_leaf() || (!a.is_leaf() && cost(a.box) >= cost(b.box))) {
+                pending.emplace_back(a.child1, pair.second);
+                pending.emplace_back(a.child2, pair.second);
+            } else {
+                pending.emplace_back(pair.first, b.child1);
+                pending.emplace_back(pair.first, b.child2);
+            }
+        };
+
+        const size_t num_threads = executor.num_threads();
+        std::vector<NodePair> frontier{NodePair(root_, other.root_)};
+        while (num_threads > 1 && !frontier.empty() && frontier.size() < 8 * num_threads) {
+            std::vector<NodePair> next;
+            for (const NodePair& pair : frontier) {
+                refine(pair, next, result);
+            }
+            frontier.swap(next);
+        }
+
+        std::vector<std::vector<NodePair>> found(num_threads);
+        auto run = [&](size_t worker) {
+            std::vector<NodePair> stack;
+            for (size_t i = worker; i < frontier.size(); i += num_threads) {
+                stack.push_back(frontier[i]);
+                while (!stack.empty()) {
+                    NodePair pair = stack.back();
+                    stack.pop_back();
+                    refine(pair, stack, found[worker]);
+                }
+            }
+        };
+        executor.pool().run(num_threads, run);
+
+        for (const auto& pairs : found) {
+            result.insert(result.end(), pairs.begin(), pairs.end());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    struct Node {
+        BoundingBox<T, Dim> box;
+        // Parent of a node in the tree, next free node of a free node.
+        int32_t parent = kNullNode;
+        int32_t child1 = kNullNode;
+        int32_t child2 = kNullNode;
+        // 0 for leaves, -1 for free nodes.
+        int32_t height = -1;
+
+        bool is_leaf() const { return child1 == kNullNode; }
+    };
+
+    T margin_;
+    T displacement_factor_;
+    std::pmr::vector<Node> nodes_;
+    // Segment of each leaf, indexed like nodes_.
+    std::pmr::vector<LineSegment<T, Dim>> segments_;
+    int32_t root_ = kNullNode;
+    int32_t free_list_ = kNullNode;
+    size_t num_proxies_ = 0;
+
+    // Insertion cost of a box: the sum of its extents, which, like surface
+    // area, favours compact boxes.
+    static T cost(const BoundingBox<T, Dim>& box) {
+        T sum{};
+        for (size_t i = 0; i < Dim; ++i) {
+            sum += box.extent(i);
+        }
+        return sum;
+    }
+
+    static BoundingBox<T, Dim> merged(const BoundingBox<T, Dim>& a, const BoundingBox<T, Dim>& b) {
+        BoundingBox<T, Dim> box = a;
+        box.expand(b);
+        return box;
+    }
+
+    BoundingBox<T, Dim> fatten(const LineSegment<T, Dim>& segment, const Point<T, Dim>& displacement) const {
+        BoundingBox<T, Dim> box;
+        box.expand(segment.start());
+        box.expand(segment.end());
+        box.inflate(margin_);
+        Point<T, Dim> min = box.min();
+        Point<T, Dim> max = box.max();
+        for (size_t i = 0; i < Dim; ++i) {
+            T reach = displacement_factor_ * displacement[i];
+            if (reach < 0) min[i] += reach;
+            else max[i] += reach;
+        }
+        return BoundingBox<T, Dim>(min, max);
+    }
+
+    void check_proxy(int32_t proxy) const {
+        if (proxy < 0 || static_cast<size_t>(proxy) >= nodes_.size() || nodes_[proxy].height != 0) {
+            throw std::invalid_argument("Not a live proxy of this tree");
+        }
+    }
+
+    int32_t allocate_node() {
+        if (free_list_ == kNullNode) {
+            nodes_.emplace_back();
+            segments_.emplace_back();
+            return static_cast<int32_t>(nodes_.size() - 1);
+        }
+        int32_t index = free_list_;
+        free_list_ = nodes_[index].parent;
+        nodes_[index] = Node();
+        return index;
+    }
+
+    void free_node(int32_t index) {
+        nodes_[index] = Node();
+        nodes_[index].parent = free_list_;
+        free_list_ = index;
+    }
+
+    // Recomputes the height and box of an inner node from its children.
+    void refit(int32_t index) {
+        Node& node = nodes_[index];
+        node.height = 1 + std::max(nodes_[node.child1].height, nodes_[node.child2].height);
+        node.box = merged(nodes_[node.child1].box, nodes_[node.child2].box);
+    }
+
+    void insert_leaf(int32_t leaf) {
+        if (root_ == kNullNode) {
+            root_ = leaf;
+            nodes_[leaf].parent = kNullNode;
+            return;
+        }
+
+        // Descend to the best sibling: stop where pairing with the current
+        // node is cheaper than pushing the leaf into either child.
+        const BoundingBox<T, Dim> box = nodes_[leaf].box;
+        int32_t index = root_;
+        while (!nodes_[index].is_leaf()) {
+            const Node& node = nodes_[index];
+            T combined = cost(merged(node.box, box));
+            T pair_cost = 2 * combined;
+            // Every ancestor of the leaf grows by at least this much.
+            T inherited = 2 * (combined - cost(node.box));
+
+            auto descend_cost = [&](int32_t child) {
+                const Node& c = nodes_[child];
+                T grown = cost(merged(c.box, box));
+                return c.is_leaf() ? grown + inherited : grown - cost(c.box) + inherited;
+            };
+            T cost1 = descend_cost(node.child1);
+            T cost2 = descend_cost(node.child2);
+            if (pair_cost < cost1 && pair_cost < cost2) break;
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        // Pair the leaf with the sibling under a new parent.
+        int32_t sibling = index;
+        int32_t old_parent = nodes_[sibling].parent;
+        int32_t parent = allocate_node();
+        nodes_[parent].parent = old_parent;
+        nodes_[parent].child1 = sibling;
+        nodes_[parent].child2 = leaf;
+        nodes_[sibling].parent = parent;
+        nodes_[leaf].parent = parent;
+        refit(parent);
+        if (old_parent == kNullNode) {
+            root_ = parent;
+        } else if (nodes_[old_parent].child1 == sibling) {
+            nodes_[old_parent].child1 = parent;
+        } else {
+            nodes_[old_parent].child2 = parent;
+        }
+
+        fix_upwards(nodes_[leaf].parent);
+    }
+
+    void remove_leaf(int32_t leaf) {
+        if (leaf == root_) {
+            root_ = kNullNode;
+            return;
+        }
+
+        // The sibling takes the place of the parent.
+        int32_t parent = nodes_[leaf].parent;
+        int32_t grandparent = nodes_[parent].parent;
+        int32_t sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+        nodes_[sibling].parent = grandparent;
+        free_node(parent);
+        if (grandparent == kNullNode) {
+            root_ = sibling;
+            return;
+        }
+        if (nodes_[grandparent].child1 == parent) {
+            nodes_[grandparent].child1 = sibling;
+        } else {
+            nodes_[grandparent].child2 = sibling;
+        }
+        fix_upwards(grandparent);
+    }
+
+    // Rebalances and refits from a node up to the root.
+    void fix_upwards(int32_t index) {
+        while (index != kNullNode) {
+            index = balance(index);
+            refit(index);
+            index = nodes_[index].parent;
+        }
+    }
+
+    /**
+     * @brief Rotates the taller child of node a up if the heights of a's
+     * children differ by more than one.
+     * @return The index of the node now at a's position
+     */
+    int32_t balance(int32_t a) {
+        Node& node_a = nodes_[a];
+        if (node_a.is_leaf() || node_a.height < 2) return a;
+
+        int32_t b = node_a.child1;
+        int32_t c = node_a.child2;
+        int32_t skew = nodes_[c].height - nodes_[b].height;
+        if (skew > 1) return rotate_up(a, c, b);
+        if (skew < -1) return rotate_up(a, b, c);
+        return a;
+    }
+
+    /**
+     * @brief Makes the tall child of a the parent of a. The taller of its
+     * children stays with it and the other becomes a's child, replacing tall.
+     * @param a The unbalanced node
+     * @param tall The taller child of a
+     * @param short_child The other child of a
+     * @return tall, now at a's position
+     */
+    int32_t rotate_up(int32_t a, int32_t tall, int32_t short_child) {
+        int32_t f = nodes_[tall].child1;
+        int32_t g = nodes_[tall].child2;
+
+        // tall replaces a under a's parent.
+        int32_t parent = nodes_[a].parent;
+        nodes_[tall].parent = parent;
+        nodes_[a].parent = tall;
+        if (parent == kNullNode) {
+            root_ = tall;
+        } else if (nodes_[parent].child1 == a) {
+            nodes_[parent].child1 = tall;
+        } else {
+            nodes_[parent].child2 = tall;
+        }
+
+        // Keep the taller grandchild under tall and hand the other to a.
+        int32_t keep = nodes_[f].height > nodes_[g].height ? f : g;
+        int32_t give = keep == f ? g : f;
+        nodes_[tall].child1 = a;
+        nodes_[tall].child2 = keep;
+        nodes_[a].child1 = short_child;
+        nodes_[a].child2 = give;
+        nodes_[give].parent = a;
+        refit(a);
+        refit(tall);
+        return tall;
+    }
+};
+
+} // namespace geometry
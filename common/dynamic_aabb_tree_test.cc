@@ -0,0 +1,80 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "dynamic_aabb_tree.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: A few segments
+    DynamicAabbTree<double, 2> tree(0.1);
+    int32_t a = tree.insert(LineSegment<double, 2>(Point<double, 2>(0, 0), Point<double, 2>(1, 1)));
+    int32_t b = tree.insert(LineSegment<double, 2>(Point<double, 2>(2, 2), Point<double, 2>(3, 3)));
+    tree.insert(LineSegment<double, 2>(Point<double, 2>(0, 3), Point<double, 2>(1, 2)));
+    std::cout << "Test 1 - Small tree:" << std::endl;
+    std::cout << "Proxies: " << tree.size() << ", height " << tree.height() << std::endl;
+    std::cout << "Fat box of first segment: " << tree.fat_box(a) << std::endl;
+    std::cout << "Small move reinserts? " << (tree.update(a, LineSegment<double, 2>(Point<double, 2>(0.05, 0), Point<double, 2>(1.05, 1))) ? "Yes" : "No") << std::endl;
+    std::cout << "Large move reinserts? " << (tree.update(a, LineSegment<double, 2>(Point<double, 2>(1.5, 1.5), Point<double, 2>(2.5, 2.5))) ? "Yes" : "No") << std::endl;
+    std::vector<int32_t> hits;
+    tree.query(BoundingBox<double, 2>(Point<double, 2>(2.2, 2.2), Point<double, 2>(2.4, 2.4)), [&](int32_t proxy) {
+        hits.push_back(proxy);
+        return true;
+    });
+    std::cout << "Proxies overlapping [2.2, 2.4]^2: " << hits.size() << std::endl;
+    tree.remove(b);
+    std::cout << "Proxies after removal: " << tree.size() << std::endl;
+    try {
+        tree.remove(b);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Removing twice: " << e.what() << std::endl;
+    }
+    std::cout << std::endl;
+
+    // Test case 2: Churn against brute force
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::uniform_real_distribution<double> step(-0.5, 0.5);
+    auto random_segment = [&]() {
+        Point<double, 3> start(coordinate(rng), coordinate(rng), coordinate(rng));
+        return LineSegment<double, 3>(start, start + Point<double, 3>(step(rng), step(rng), step(rng)) * 4);
+    };
+
+    DynamicAabbTree<double, 3> moving(0.2), fixed(0.2);
+    std::vector<int32_t> moving_proxies, fixed_proxies;
+    for (int i = 0; i < 4000; ++i) {
+        moving_proxies.push_back(moving.insert(random_segment()));
+        fixed_proxies.push_back(fixed.insert(random_segment()));
+    }
+    size_t reinserted = 0;
+    for (int tick = 0; tick < 20; ++tick) {
+        for (int32_t& proxy : moving_proxies) {
+            const LineSegment<double, 3>& s = moving.segment(proxy);
+            Point<double, 3> d(step(rng) * 0.1, step(rng) * 0.1, step(rng) * 0.1);
+            reinserted += moving.update(proxy, LineSegment<double, 3>(s.start() + d, s.end() + d), d);
+        }
+        // Replace a few percent of the segments.
+        for (int i = 0; i < 100; ++i) {
+            size_t k = rng() % moving_proxies.size();
+            moving.remove(moving_proxies[k]);
+            moving_proxies[k] = moving.insert(random_segment());
+        }
+    }
+
+    std::vector<std::pair<int32_t, int32_t>> expected;
+    for (int32_t p : moving_proxies) {
+        for (int32_t q : fixed_proxies) {
+            if (moving.fat_box(p).intersects(fixed.fat_box(q))) expected.emplace_back(p, q);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    std::cout << "Test 2 - Churn:" << std::endl;
+    std::cout << "Proxies: " << moving.size() << ", height " << moving.height() << std::endl;
+    std::cout << "Height within 2 log2(n)? " << (moving.height() <= 2 * std::log2(moving.size()) ? "Yes" : "No") << std::endl;
+    std::cout << "Updates that reinserted: " << reinserted << " of " << 20 * moving_proxies.size() << std::endl;
+    std::cout << "Overlapping pairs: " << expected.size() << std::endl;
+    std::cout << "Matches brute force (1 thread)? " << (moving.overlapping_pairs(fixed, 1) == expected ? "Yes" : "No") << std::endl;
+    std::cout << "Matches brute force (4 threads)? " << (moving.overlapping_pairs(fixed, 4) == expected ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "common/bounding_box.hh"
+#include "common/point.hh"
+#include "common/surface.hh"
+#include "common/thread_pool.hh"
+
+namespace geometry {
+
+/**
+ * @brief Bounding volume hierarchy over the facets of a Surface<T, 3>.
+ *
+ * Built top-down by median splits of the facet centroids along the widest
+ * axis. Nodes live in one flat array in depth-first order: the left child of
+ * an inner node is the next node and the right child is stored in the node.
+ * Leaves reference contiguous runs of facets(), whose bounds are kept next to
+ * them in facet_bounds().
+ */
+template <typename T>
+class FacetBvh {
+public:
+    struct Node {
+        BoundingBox<T, 3> bounds;
+        uint32_t first;   // Leaf: first position in facets(). Inner: index of the right child.
+        uint32_t count;   // Leaf: number of facets. Inner: 0.
+    };
+
+    FacetBvh() = default;
+
+    /**
+     * @brief Builds the hierarchy. The top levels are built in parallel.
+     * @param surface The surface whose facets are indexed (not copied; must outlive queries by index)
+     * @param executor Pool and number of threads used for construction
+     * @param leaf_size Maximum number of facets per leaf
+     * @param resource Where the nodes and facet lists are allocated
+     */
+    explicit FacetBvh(const Surface<T, 3>& surface,
+                      Executor executor = Executor(),
+                      size_t leaf_size = 4,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : nodes_(resource), facets_(resource), facet_bounds_(resource), leaf_size_(std::max<size_t>(leaf_size, 1)) {
+        const size_t n = surface.num_facets();
+        if (n >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("FacetBvh supports at most 2^32 - 1 facets");
+        }
+        if (n == 0) return;
+
+        facets_.resize(n);
+        std::iota(facets_.begin(), facets_.end(), 0);
+        facet_bounds_.resize(n);
+        centroids_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            for (const auto& vertex : surface.facets[i].vertices) {
+                facet_bounds_[i].expand(vertex);
+            }
+            centroids_[i] = surface.facets[i].centroid();
+        }
+
+        std::map<size_t, uint32_t> subtree_sizes;
+        nodes_.resize(count_nodes(n, subtree_sizes));
+        build(0, 0, static_cast<uint32_t>(n), executor.pool(), executor.num_threads(), subtree_sizes);
+
+        // Keep the facet bounds in leaf order, next to facets().
+        std::pmr::vector<BoundingBox<T, 3>> ordered(n, resource);
+        for (size_t i = 0; i < n; ++i) {
+            ordered[i] = facet_bounds_[facets_[i]];
+        }
+        facet_bounds_ = std::move(ordered);
+        centroids_.clear();
+        centroids_.shrink_to_fit();
+    }
+
+    bool empty() const { return nodes_.empty(); }
+
+    const std::pmr::vector<Node>& nodes() const { return nodes_; }
+
+    // Facet indices in leaf order.
+    const std::pmr::vector<uint32_t>& facets() const { return facets_; }
+
+    // Bounds of facets()[i].
+    const std::pmr::vector<BoundingBox<T, 3>>& facet_bounds() const { return facet_bounds_; }
+
+    static bool is_leaf(const Node& node) { return node.count != 0; }
+
+    static uint32_t left_child(uint32_t index) { return index + 1; }
+
+    uint32_t right_child(uint32_t index) const { return nodes_[index].first; }
+
+private:
+    // Subtrees larger than this are handed to a second thread during build.
+    static constexpr size_t kParallelBuildThreshold = 1 << 15;
+
+    std::pmr::vector<Node> nodes_;
+    std::pmr::vector<uint32_t> facets_;
+    std::pmr::vector<BoundingBox<T, 3>> facet_bounds_;
+    std::vector<Point<T, 3>> centroids_;   // Only used during build
+    size_t leaf_size_ = 4;
+
+    // Number of nodes of a subtree over n facets. Memoized; the median splits
+    // produce at most two distinct sizes per level.
+    uint32_t count_nodes(size_t n, std::map<size_t, uint32_t>& memo) const {
+        auto it = memo.find(n);
+        if (it != memo.end()) return it->second;
+        uint32_t count = 1;
+        if (n > leaf_size_) {
+            count += count_nodes(n / 2, memo) + count_nodes(n - n / 2, memo);
+        }
+        memo[n] = count;
+        return count;
+    }
+
+    void build(uint32_t index, uint32_t begin, uint32_t end, ThreadPool& pool, size_t num_threads,
+               const std::map<size_t, uint32_t>& subtree_sizes) {
+        Node& node = nodes_[index];
+        BoundingBox<T, 3> centroid_bounds;
+        for (uint32_t i = begin; i < end; ++i) {
+            node.bounds.expand(facet_bounds_[facets_[i]]);
+            centroid_bounds.expand(centroids_[facets_[i]]);
+        }
+        if (end - begin <= leaf_size_) {
+            node.first = begin;
+            node.count = end - begin;
+            return;
+        }
+
+        const size_t axis = centroid_bounds.longest_axis();
+        const uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(facets_.begin() + begin, facets_.begin() + mid, facets_.begin() + end,
+                         [this, axis](uint32_t a, uint32_t b) { return centroids_[a][axis] < centroids_[b][axis]; });
+
+        const uint32_t left = index + 1;
+        const uint32_t right = left + subtree_sizes.at(mid - begin);
+        node.first = right;
+        node.count = 0;
+
+        if (num_threads > 1 && end - begin > kParallelBuildThreshold) {
+            pool.run(2, [&](size_t side) {
+                if (side == 0) build(left, begin, mid, pool, num_threads / 2, subtree_sizes);
+                else build(right, mid, end, pool, num_threads - num_threads / 2, subtree_sizes);
+            });
+        } else {
+            build(left, begin, mid, pool, 1, subtree_sizes);
+            build(right, mid, end, pool, 1, subtree_sizes);
+        }
+    }
+};
+
+} // namespace geometry
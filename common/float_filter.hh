@@ -0,0 +1,157 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "common/line_segment.hh"
+
+namespace geometry {
+
+/**
+ * @brief Shared pieces of the mixed-precision predicates.
+ * A predicate is first evaluated in float32 together with a forward error
+ * bound; only inputs whose float32 result is not certain under that bound are
+ * re-evaluated in double.
+ */
+
+// Unit roundoff of float32, u = 2^-24.
+constexpr double kFloatUnitRoundoff = 5.9604644775390625e-8;
+
+// Result codes of a float32 filter.
+enum class FilterResult : uint8_t {
+    kNoIntersection = 0,
+    kIntersection = 1,
+    kAmbiguous = 2,
+};
+
+// The batch filters work on vectors of kFilterLanes float32 lanes, as wide
+// as the registers of the target: 4 with SSE, 8 with AVX and 16 with AVX-512.
+// FloatBlock, the comparison mask MaskBlock and the result bytes ByteBlock
+// are GCC/Clang vector extensions, so each operation on them is a single
+// instruction whether or not the auto-vectorizer is enabled.
+#if defined(__AVX512F__)
+constexpr size_t kFilterLanes = 16;
+#elif defined(__AVX__)
+constexpr size_t kFilterLanes = 8;
+#else
+constexpr size_t kFilterLanes = 4;
+#endif
+
+using FloatBlock = float __attribute__((vector_size(kFilterLanes * sizeof(float))));
+using MaskBlock = int32_t __attribute__((vector_size(kFilterLanes * sizeof(int32_t))));
+using ByteBlock = uint8_t __attribute__((vector_size(kFilterLanes)));
+
+// FloatSegments columns are padded to a multiple of kFilterBlock, which is a
+// multiple of kFilterLanes for every target.
+constexpr size_t kFilterBlock = 16;
+
+/**
+ * @brief Rounds segments to float32 columns (start x, start y, [start z,]
+ * end x, end y, [end z]) and records the largest coordinate magnitude of
+ * each endpoint.
+ */
+template <typename T, size_t Dim>
+void to_float_columns(const LineSegment<T, Dim>* segments, size_t count, float* const* columns,
+                      float* start_magnitudes, float* end_magnitudes) {
+    for (size_t s = 0; s < count; ++s) {
+        float start_magnitude = 0.0f, end_magnitude = 0.0f;
+        for (size_t i = 0; i < Dim; ++i) {
+            const float start = static_cast<float>(segments[s].start()[i]);
+            const float end = static_cast<float>(segments[s].end()[i]);
+            columns[i][s] = start;
+            columns[Dim + i][s] = end;
+            start_magnitude = std::max(start_magnitude, std::abs(start));
+            end_magnitude = std::max(end_magnitude, std::abs(end));
+        }
+        start_magnitudes[s] = start_magnitude;
+        end_magnitudes[s] = end_magnitude;
+    }
+}
+
+/**
+ * @brief Runs a batch filter over segments that are converted to float32
+ * columns on the stack a few hundred at a time, so that the float32 copy
+ * stays in the cache instead of being written out and read back.
+ * @param segments The segments to filter
+ * @param results Receives one FilterResult per segment
+ * @param filter Called as filter(columns, start_magnitudes, end_magnitudes,
+ * count, results), with count a multiple of kFilterLanes
+ */
+template <typename T, size_t Dim, typename Filter>
+void filter_staged(const std::vector<LineSegment<T, Dim>>& segments, std::vector<uint8_t>& results, Filter filter) {
+    constexpr size_t kStage = 16 * kFilterBlock;
+    alignas(64) float staged[2 * Dim + 2][kStage];
+    float* columns[2 * Dim];
+    for (size_t c = 0; c < 2 * Dim; ++c) {
+        columns[c] = staged[c];
+    }
+    uint8_t staged_results[kStage];
+    results.resize(segments.size());
+    for (size_t begin = 0; begin < segments.size(); begin += kStage) {
+        const size_t count = std::min(kStage, segments.size() - begin);
+        const size_t padded = (count + kFilterBlock - 1) / kFilterBlock * kFilterBlock;
+        to_float_columns(segments.data() + begin, count, columns, staged[2 * Dim], staged[2 * Dim + 1]);
+        for (size_t c = 0; c < 2 * Dim + 2; ++c) {
+            std::fill(staged[c] + count, staged[c] + padded, 0.0f);
+        }
+        filter(columns, staged[2 * Dim], staged[2 * Dim + 1], padded, staged_results);
+        std::memcpy(results.data() + begin, staged_results, count);
+    }
+}
+
+/**
+ * @brief A batch of segments rounded to float32 for the batch filters, stored
+ * column by column (start x, start y, [start z,] end x, end y, [end z]) along
+ * with the largest coordinate magnitude of each endpoint. The columns are
+ * padded with zeros to a whole number of blocks. Build it once for a batch
+ * that is tested against several queries.
+ */
+template <size_t Dim>
+class FloatSegments {
+public:
+    FloatSegments() = default;
+
+    template <typename T>
+    explicit FloatSegments(const std::vector<LineSegment<T, Dim>>& segments) {
+        assign(segments);
+    }
+
+    template <typename T>
+    void assign(const std::vector<LineSegment<T, Dim>>& segments) {
+        size_ = segments.size();
+        const size_t padded = (size_ + kFilterBlock - 1) / kFilterBlock * kFilterBlock;
+        float* columns[2 * Dim];
+        for (size_t c = 0; c < 2 * Dim; ++c) {
+            columns_[c].resize(padded);
+            std::fill(columns_[c].begin() + size_, columns_[c].end(), 0.0f);
+            columns[c] = columns_[c].data();
+        }
+        for (std::vector<float>& magnitude : magnitudes_) {
+            magnitude.resize(padded);
+            std::fill(magnitude.begin() + size_, magnitude.end(), 0.0f);
+        }
+        to_float_columns(segments.data(), size_, columns, magnitudes_[0].data(), magnitudes_[1].data());
+    }
+
+    size_t size() const { return size_; }
+
+    // Length of every column, a multiple of kFilterBlock.
+    size_t padded_size() const { return columns_[0].size(); }
+
+    const float* column(size_t c) const { return columns_[c].data(); }
+
+    // Largest coordinate magnitude of the start (0) or end (1) points.
+    const float* magnitude(size_t endpoint) const { return magnitudes_[endpoint].data(); }
+
+private:
+    size_t size_ = 0;
+    std::array<std::vector<float>, 2 * Dim> columns_;
+    std::array<std::vector<float>, 2> magnitudes_;
+};
+
+} // namespace geometry
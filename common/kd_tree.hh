@@ -0,0 +1,371 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "common/bounding_box.hh"
+#include "common/parallel_runs.hh"
+#include "common/point.hh"
+
+namespace geometry {
+
+/**
+ * @brief Static k-d tree over Point<T, Dim> for nearest-neighbour, radius and
+ * box queries.
+ *
+ * The tree is bulk-built by median splits along the widest dimension of each
+ * node's points. Nodes live in one flat array in depth-first order, so the
+ * left child of a node is the next element and descending left stays in the
+ * same cache line. Leaves reference contiguous runs of a reordered copy of the
+ * points. Query results refer to points by their index in the input vector.
+ */
+template <typename T, size_t Dim>
+class KdTree {
+public:
+    struct Neighbor {
+        uint32_t index;       // Index of the point in the input
+        T squared_distance;   // Squared distance to the query point
+    };
+
+    KdTree() = default;
+
+    /**
+     * @brief Builds the tree. The top levels are built in parallel.
+     * @param points The points to index (copied)
+     * @param executor Pool and number of threads used for construction
+     * @param leaf_size Maximum number of points per leaf
+     * @param resource Where the points and nodes are allocated
+     */
+    explicit KdTree(const std::vector<Point<T, Dim>>& points,
+                    Executor executor = Executor(),
+                    size_t leaf_size = 16,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : entries_(resource), nodes_(resource), positions_(resource), leaf_size_(std::max<size_t>(leaf_size, 1)) {
+        if (points.size() >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("KdTree supports at most 2^32 - 1 points");
+        }
+        entries_.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            entries_[i] = Entry{points[i], static_cast<uint32_t>(i)};
+        }
+        if (entries_.empty()) return;
+
+        std::map<size_t, uint32_t> subtree_sizes;
+        positions_.resize(entries_.size());
+        nodes_.resize(count_nodes(entries_.size(), subtree_sizes));
+        build(0, 0, static_cast<uint32_t>(entries_.size()), executor.pool(), executor.num_threads(),
+              subtree_sizes);
+    }
+
+    size_t size() const { return entries_.size(); }
+
+    size_t num_nodes() const { return nodes_.size(); }
+
+    /**
+     * @brief Finds the k points closest to a query point.
+     * @param query The query point
+     * @param k Number of neighbours to return
+     * @return Up to k neighbours, closest first
+     */
+    std::vector<Neighbor> nearest(const Point<T, Dim>& query, size_t k) const {
+        std::vector<Neighbor> heap;
+        search_nearest(query, k, heap, false);
+        std::sort_heap(heap.begin(), heap.end(), closer);
+        return heap;
+    }
+
+    /**
+     * @brief Finds the k nearest neighbours of many query points.
+     * Queries are processed in tree order and split into contiguous runs, one
+     * per thread. Within a run, each search starts from the previous query's
+     * neighbours, which usually bounds it tightly before any node is visited.
+     * @param queries The query points
+     * @param k Number of neighbours per query
+     * @param executor Pool and number of threads
+     * @return For each query, up to k neighbours, closest first
+     */
+    std::vector<std::vector<Neighbor>> nearest(const std::vector<Point<T, Dim>>& queries, size_t k,
+                                               Executor executor = Executor()) const {
+        std::vector<std::vector<Neighbor>> results(queries.size());
+        std::vector<uint32_t> order = tree_order(queries);
+        for_each_run(order.size(), executor, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                std::vector<Neighbor> heap;
+                bool seeded = false;
+                if (i > begin) {
+                    // Seed with the previous query's neighbours.
+                    const Point<T, Dim>& query = queries[order[i]];
+                    for (const Neighbor& previous : results[order[i - 1]]) {
+                        heap.push_back({previous.index, squared_norm(points_by_index(previous.index) - query)});
+                        std::push_heap(heap.begin(), heap.end(), closer);
+                    }
+                    seeded = !heap.empty();
+                }
+                search_nearest(queries[order[i]], k, heap, seeded);
+                std::sort_heap(heap.begin(), heap.end(), closer);
+                results[order[i]] = std::move(heap);
+            }
+        });
+        return results;
+    }
+
+    /**
+     * @brief Finds all points within a radius of a query point.
+     * @param query The query point
+     * @param radius The search radius (inclusive)
+     * @return Indices of the points found, in no particular order
+     */
+    std::vector<uint32_t> radius(const Point<T, Dim>& query, T radius) const {
+        std::vector<uint32_t> found;
+        search_radius(query, radius * radius, found);
+        return found;
+    }
+
+    /**
+     * @brief Radius search for many query points, processed in tree order.
+     * @param queries The query points
+     * @param radius The search radius (inclusive)
+     * @param executor Pool and number of threads
+     * @return For each query, indices of the points found
+     */
+    std::vector<std::vector<uint32_t>> radius(const std::vector<Point<T, Dim>>& queries, T radius,
+                                              Executor executor = Executor()) const {
+        std::vector<std::vector<uint32_t>> results(queries.size());
+        std::vector<uint32_t> order = tree_order(queries);
+        for_each_run(order.size(), executor, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                search_radius(queries[order[i]], radius * radius, results[order[i]]);
+            }
+        });
+        return results;
+    }
+
+    /**
+     * @brief Finds all points inside an axis-aligned box (boundary included).
+     * @param box The query box
+     * @return Indices of the points found, in no particular order
+     */
+    std::vector<uint32_t> box(const BoundingBox<T, Dim>& box) const {
+        std::vector<uint32_t> found;
+        if (nodes_.empty()) return found;
+
+        uint32_t stack[kMaxDepth];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            uint32_t index = stack[--top];
+            const Node& node = nodes_[index];
+            if (node.right == 0) {
+                for (uint32_t i = node.begin; i < node.end; ++i) {
+                    if (box.contains(entries_[i].point)) found.push_back(entries_[i].index);
+                }
+                continue;
+            }
+            if (box.max()[node.dim] >= node.split) stack[top++] = node.right;
+            if (box.min()[node.dim] <= node.split) stack[top++] = index + 1;
+        }
+        return found;
+    }
+
+private:
+    struct Entry {
+        Point<T, Dim> point;
+        uint32_t index;
+    };
+
+    // Inner nodes split [begin, end) at the median: entries before it have
+    // point[dim] <= split, entries after it point[dim] >= split.
+    struct Node {
+        T split;
+        uint32_t begin;   // First entry of the subtree
+        uint32_t end;     // One past the last entry of the subtree
+        uint32_t right;   // Index of the right child, 0 for a leaf
+        uint32_t dim;     // Split dimension
+    };
+
+    // Median splits keep the depth below 33 for 2^32 points, and the traversal
+    // stacks hold at most one pending sibling per level.
+    static constexpr size_t kMaxDepth = 66;
+
+    // Subtrees larger than this are handed to a second thread during build.
+    static constexpr size_t kParallelBuildThreshold = 1 << 16;
+
+    std::pmr::vector<Entry> entries_;
+    std::pmr::vector<Node> nodes_;
+    std::pmr::vector<uint32_t> positions_;   // Entry position of each input index
+    size_t leaf_size_ = 16;
+
+    static bool closer(const Neighbor& a, const Neighbor& b) {
+        return a.squared_distance < b.squared_distance;
+    }
+
+    const Point<T, Dim>& points_by_index(uint32_t index) const {
+        return entries_[positions_[index]].point;
+    }
+
+    // Number of nodes of a subtree over n points. Memoized; the median splits
+    // produce at most two distinct sizes per level.
+    uint32_t count_nodes(size_t n, std::map<size_t, uint32_t>& memo) const {
+        auto it = memo.find(n);
+        if (it != memo.end()) return it->second;
+        uint32_t count = 1;
+        if (n > leaf_size_) {
+            count += count_nodes(n / 2, memo) + count_nodes(n - n / 2, memo);
+        }
+        memo[n] = count;
+        return count;
+    }
+
+    void build(uint32_t index, uint32_t begin, uint32_t end, ThreadPool& pool, size_t num_threads,
+               const std::map<size_t, uint32_t>& subtree_sizes) {
+        Node& node = nodes_[index];
+        node.begin = begin;
+        node.end = end;
+        node.right = 0;
+        node.dim = 0;
+        node.split = T{};
+
+        if (end - begin <= leaf_size_) {
+            for (uint32_t i = begin; i < end; ++i) {
+                positions_[entries_[i].index] = i;
+            }
+            return;
+        }
+
+        BoundingBox<T, Dim> bounds;
+        for (uint32_t i = begin; i < end; ++i) {
+            bounds.expand(entries_[i].point);
+        }
+        const size_t dim = bounds.longest_axis();
+        const uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(entries_.begin() + begin, entries_.begin() + mid, entries_.begin() + end,
+                         [dim](const Entry& a, const Entry& b) { return a.point[dim] < b.point[dim]; });
+
+        node.dim = static_cast<uint32_t>(dim);
+        node.split = entries_[mid].point[dim];
+        const uint32_t left = index + 1;
+        const uint32_t right = left + subtree_sizes.at(mid - begin);
+        node.right = right;
+
+        if (num_threads > 1 && end - begin > kParallelBuildThreshold) {
+            pool.run(2, [&](size_t side) {
+                if (side == 0) build(left, begin, mid, pool, num_threads / 2, subtree_sizes);
+                else build(right, mid, end, pool, num_threads - num_threads / 2, subtree_sizes);
+            });
+        } else {
+            build(left, begin, mid, pool, 1, subtree_sizes);
+            build(right, mid, end, pool, 1, subtree_sizes);
+        }
+    }
+
+    // Grows a max-heap of the k closest points seen so far. When the heap was
+    // seeded with known points, those are skipped if found again.
+    void search_nearest(const Point<T, Dim>& query, size_t k, std::vector<Neighbor>& heap, bool seeded) const {
+        if (nodes_.empty() || k == 0) return;
+        while (heap.size() > k) {
+            std::pop_heap(heap.begin(), heap.end(), closer);
+            heap.pop_back();
+        }
+        auto worst = [&]() {
+            return heap.size() < k ? std::numeric_limits<T>::max() : heap.front().squared_distance;
+        };
+
+        struct Pending {
+            uint32_t node;
+            T bound;   // Lower bound of the distance to any point of the subtree
+        };
+        Pending stack[kMaxDepth];
+        size_t top = 0;
+        stack[top++] = {0, T{}};
+        while (top > 0) {
+            Pending pending = stack[--top];
+            if (pending.bound >= worst()) continue;
+
+            uint32_t index = pending.node;
+            while (nodes_[index].right != 0) {
+                const Node& node = nodes_[index];
+                T diff = query[node.dim] - node.split;
+                uint32_t near = diff < 0 ? index + 1 : node.right;
+                uint32_t far = diff < 0 ? node.right : index + 1;
+                T far_bound = std::max(pending.bound, diff * diff);
+                if (far_bound < worst()) stack[top++] = {far, far_bound};
+                index = near;
+            }
+
+            const Node& leaf = nodes_[index];
+            for (uint32_t i = leaf.begin; i < leaf.end; ++i) {
+                T d = squared_norm(entries_[i].point - query);
+                if (heap.size() < k) {
+                    if (seeded && contains(heap, entries_[i].index)) continue;
+                    heap.push_back({entries_[i].index, d});
+                    std::push_heap(heap.begin(), heap.end(), closer);
+                } else if (d < heap.front().squared_distance) {
+                    if (seeded && contains(heap, entries_[i].index)) continue;
+                    std::pop_heap(heap.begin(), heap.end(), closer);
+                    heap.back() = {entries_[i].index, d};
+                    std::push_heap(heap.begin(), heap.end(), closer);
+                }
+            }
+        }
+    }
+
+    static bool contains(const std::vector<Neighbor>& heap, uint32_t index) {
+        for (const Neighbor& n : heap) {
+            if (n.index == index) return true;
+        }
+        return false;
+    }
+
+    void search_radius(const Point<T, Dim>& query, T squared_radius, std::vector<uint32_t>& found) const {
+        if (nodes_.empty()) return;
+        uint32_t stack[kMaxDepth];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            uint32_t index = stack[--top];
+            while (nodes_[index].right != 0) {
+                const Node& node = nodes_[index];
+                T diff = query[node.dim] - node.split;
+                uint32_t near = diff < 0 ? index + 1 : node.right;
+                uint32_t far = diff < 0 ? node.right : index + 1;
+                if (diff * diff <= squared_radius) stack[top++] = far;
+                index = near;
+            }
+            const Node& leaf = nodes_[index];
+            for (uint32_t i = leaf.begin; i < leaf.end; ++i) {
+                if (squared_norm(entries_[i].point - query) <= squared_radius) {
+                    found.push_back(entries_[i].index);
+                }
+            }
+        }
+    }
+
+    // Orders queries by the leaf they fall into, so that consecutive queries
+    // traverse the same part of the tree.
+    std::vector<uint32_t> tree_order(const std::vector<Point<T, Dim>>& queries) const {
+        std::vector<uint32_t> order(queries.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (nodes_.empty()) return order;
+        std::vector<uint32_t> leaf(queries.size());
+        for (size_t q = 0; q < queries.size(); ++q) {
+            uint32_t index = 0;
+            while (nodes_[index].right != 0) {
+                const Node& node = nodes_[index];
+                index = queries[q][node.dim] < node.split ? index + 1 : node.right;
+            }
+            leaf[q] = index;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return leaf[a] < leaf[b]; });
+        return order;
+    }
+};
+
+} // namespace geometry
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include "kd_tree.hh"
+
+int main() {
+    using namespace geometry;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordinate(-100.0, 100.0);
+    std::vector<Point<double, 3>> points;
+    for (int i = 0; i < 100000; ++i) {
+        points.emplace_back(coordinate(generator), coordinate(generator), coordinate(generator));
+    }
+    KdTree<double, 3> tree(points);
+
+    std::vector<Point<double, 3>> queries;
+    for (int i = 0; i < 200; ++i) {
+        queries.emplace_back(coordinate(generator), coordinate(generator), coordinate(generator));
+    }
+
+    // Test case 1: k nearest neighbours against brute force
+    const size_t k = 8;
+    bool knn_matches = true;
+    std::vector<std::vector<KdTree<double, 3>::Neighbor>> batch = tree.nearest(queries, k);
+    for (size_t q = 0; q < queries.size(); ++q) {
+        std::vector<double> expected;
+        for (const auto& p : points) {
+            expected.push_back(squared_norm(p - queries[q]));
+        }
+        std::partial_sort(expected.begin(), expected.begin() + k, expected.end());
+        std::vector<KdTree<double, 3>::Neighbor> single = tree.nearest(queries[q], k);
+        for (size_t i = 0; i < k; ++i) {
+            knn_matches = knn_matches && single[i].squared_distance == expected[i] &&
+                          batch[q][i].squared_distance == expected[i];
+        }
+    }
+    std::cout << "Test 1 - k nearest neighbours:" << std::endl;
+    std::cout << "Tree with " << tree.size() << " points and " << tree.num_nodes() << " nodes" << std::endl;
+    std::cout << "Closest point to " << queries[0] << ": " << points[batch[0][0].index] << std::endl;
+    std::cout << "Single and batch queries match brute force? " << (knn_matches ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: radius query against brute force
+    const double radius = 10.0;
+    bool radius_matches = true;
+    std::vector<std::vector<uint32_t>> radius_batch = tree.radius(queries, radius);
+    for (size_t q = 0; q < queries.size(); ++q) {
+        size_t expected = 0;
+        for (const auto& p : points) {
+            expected += squared_norm(p - queries[q]) <= radius * radius;
+        }
+        radius_matches = radius_matches && tree.radius(queries[q], radius).size() == expected &&
+                         radius_batch[q].size() == expected;
+    }
+    std::cout << "Test 2 - Radius query:" << std::endl;
+    std::cout << "Points within " << radius << " of " << queries[0] << ": " << radius_batch[0].size() << std::endl;
+    std::cout << "Matches brute force? " << (radius_matches ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: box query against brute force
+    BoundingBox<double, 3> box(Point<double, 3>(-10, -20, -30), Point<double, 3>(10, 20, 30));
+    size_t expected = 0;
+    for (const auto& p : points) {
+        expected += box.contains(p);
+    }
+    std::cout << "Test 3 - Box query:" << std::endl;
+    std::cout << "Points inside " << box << ": " << tree.box(box).size() << std::endl;
+    std::cout << "Matches brute force? " << (tree.box(box).size() == expected ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
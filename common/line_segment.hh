@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <cmath>
+
 #include "common/point.hh"
 
 namespace geometry {
@@ -11,37 +13,32 @@ class LineSegment {
 public:
   LineSegment() = default;
 
-  LineSegment(const Point<T, Dim> &start, const Point<T, Dim> &end): start_(start), end_(end) {}
+  constexpr LineSegment(const Point<T, Dim> &start, const Point<T, Dim> &end): start_(start), end_(end) {}
 
-  const Point<T, Dim> start() const { return start_; }
-  const Point<T, Dim> end() const { return end_; }
+  constexpr const Point<T, Dim>& start() const { return start_; }
+  constexpr const Point<T, Dim>& end() const { return end_; }
 
   /**
      * @brief Calculates the length (Euclidean distance) of the line segment.
      * @return The length as a double.
      */
     double length() const {
-        double squared_sum = 0.0;
         // The length is the square root of the sum of the squared differences
-        // of the coordinates. We can reuse the operator- from our Point class.
-        Point<T, Dim> diff = end_ - start_;
-        for (size_t i = 0; i < Dim; ++i) {
-            squared_sum += static_cast<double>(diff[i] * diff[i]);
-        }
-        return std::sqrt(squared_sum);
+        // of the coordinates. end_ - start_ is a lazy expression, so no
+        // temporary Point is created.
+        return std::sqrt(squared_norm<double>(end_ - start_));
     }
 
     /**
      * @brief Calculates the midpoint of the line segment.
      * @return A new Point representing the midpoint.
      */
-    Point<T, Dim> midpoint() const {
+    constexpr Point<T, Dim> midpoint() const {
         // The midpoint is the average of the coordinates of the two endpoints.
         // We reuse the operator+ from our Point class.
-        Point<T, Dim> sum = start_ + end_;
-        Point<T, Dim> mid;
+        Point<T, Dim> mid = start_ + end_;
         for (size_t i = 0; i < Dim; ++i) {
-            mid[i] = sum[i] / 2;
+            mid[i] /= 2;
         }
         return mid;
     }
@@ -57,7 +54,7 @@ private:
 // Equality comparison (==)
 // This definition considers two segments equal if their start and end points match.
 template <typename T, size_t Dim>
-bool operator==(const LineSegment<T, Dim>& lhs, const LineSegment<T, Dim>& rhs) {
+constexpr bool operator==(const LineSegment<T, Dim>& lhs, const LineSegment<T, Dim>& rhs) {
     return (lhs.start() == rhs.start()) && (lhs.end() == rhs.end());
 }
 
@@ -4,6 +4,11 @@
 
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "common/float_filter.hh"
 #include "common/point.hh"
 #include "common/line_segment.hh"
 
@@ -110,4 +115,225 @@ Point<T, 2> intersection_point(const LineSegment<T, 2>& seg1, const LineSegment<
     return Point<T, 2>(x, y);
 }
 
+// --- Mixed-precision evaluation ---
+//
+// The functions below evaluate the orientation tests in float32 together with
+// a forward error bound. Only pairs whose float32 result is not certain under
+// that bound are re-evaluated with the double code above, so the answers agree
+// with do_intersect() while well-separated inputs never touch double.
+
+// Error bound of the float32 orientation determinant, relative to M^2 where M
+// is the largest coordinate magnitude involved. Rounding the inputs to float
+// and the five float operations contribute at most 48 u M^2 (u = 2^-24). The
+// double evaluation itself is off by less than 2^-48 M^2, so a float32 value
+// clearing 64 u M^2 gets the same answer from orientation() in double.
+constexpr double kFloatOrientationErrorFactor = 64.0 * kFloatUnitRoundoff;
+
+// Collinearity threshold used by orientation().
+constexpr double kCollinearTolerance = 1e-9;
+
+/**
+ * @brief Evaluates orientation() in float32.
+ * @param bound The error bound of the determinant, see kFloatOrientationErrorFactor
+ * @return 1 or 2 as orientation() would return, or -1 if the determinant is too
+ * close to the collinearity threshold (or not finite) to decide in float32.
+ */
+inline int filtered_orientation(float x1, float y1, float x2, float y2,
+                                float x3, float y3, double bound) {
+    float val = (y2 - y1) * (x3 - x2) - (x2 - x1) * (y3 - y2);
+    // Written so that NaN or infinite values fall through to -1.
+    if (!(std::abs(static_cast<double>(val)) - bound > kCollinearTolerance)) return -1;
+    return (val > 0) ? 1 : 2;
+}
+
+/**
+ * @brief Runs the float32 filter on two segments given as (x1, y1, x2, y2).
+ * @return kIntersection / kNoIntersection when certain, kAmbiguous otherwise
+ */
+inline FilterResult filtered_intersect(const float (&seg1)[4], const float (&seg2)[4]) {
+    float magnitude = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        magnitude = std::max(magnitude, std::max(std::abs(seg1[i]), std::abs(seg2[i])));
+    }
+    double bound = kFloatOrientationErrorFactor * magnitude * magnitude;
+
+    int o1 = filtered_orientation(seg1[0], seg1[1], seg1[2], seg1[3], seg2[0], seg2[1], bound);
+    int o2 = filtered_orientation(seg1[0], seg1[1], seg1[2], seg1[3], seg2[2], seg2[3], bound);
+    int o3 = filtered_orientation(seg2[0], seg2[1], seg2[2], seg2[3], seg1[0], seg1[1], bound);
+    int o4 = filtered_orientation(seg2[0], seg2[1], seg2[2], seg2[3], seg1[2], seg1[3], bound);
+
+    // Collinear special cases are decided in double.
+    if (o1 < 0 || o2 < 0 || o3 < 0 || o4 < 0) return FilterResult::kAmbiguous;
+    return (o1 != o2 && o3 != o4) ? FilterResult::kIntersection : FilterResult::kNoIntersection;
+}
+
+/**
+ * @brief Converts a 2D segment to (x1, y1, x2, y2) in float32.
+ */
+template <typename T>
+void to_float(const LineSegment<T, 2>& segment, float (&out)[4]) {
+    out[0] = static_cast<float>(segment.start().x());
+    out[1] = static_cast<float>(segment.start().y());
+    out[2] = static_cast<float>(segment.end().x());
+    out[3] = static_cast<float>(segment.end().y());
+}
+
+/**
+ * @brief Converts a 2D segment to double precision.
+ */
+template <typename T>
+LineSegment<double, 2> to_double(const LineSegment<T, 2>& segment) {
+    return LineSegment<double, 2>(
+        Point<double, 2>(segment.start().x(), segment.start().y()),
+        Point<double, 2>(segment.end().x(), segment.end().y()));
+}
+
+/**
+ * @brief Determines if two line segments intersect, evaluating in float32 first.
+ * Gives the same answer as do_intersect() on the double-precision segments.
+ * @param seg1 First line segment
+ * @param seg2 Second line segment
+ * @return true if the segments intersect, false otherwise
+ */
+template <typename T>
+bool do_intersect_mixed(const LineSegment<T, 2>& seg1, const LineSegment<T, 2>& seg2) {
+    float f1[4], f2[4];
+    to_float(seg1, f1);
+    to_float(seg2, f2);
+    FilterResult result = filtered_intersect(f1, f2);
+    if (result != FilterResult::kAmbiguous) {
+        return result == FilterResult::kIntersection;
+    }
+    return do_intersect(to_double(seg1), to_double(seg2));
+}
+
+// Threshold factors of the batch filter, which compares the float32
+// determinant with a threshold computed in float32 as well: 65 u M^2 plus the
+// collinearity tolerance rounded up by 8 u stay above 64 u M^2 + 1e-9 after
+// the three roundings of the threshold computation.
+constexpr float kFloatBatchOrientationFactor = static_cast<float>(65.0 * kFloatUnitRoundoff);
+constexpr float kFloatBatchCollinearTolerance =
+        static_cast<float>(kCollinearTolerance * (1.0 + 8.0 * kFloatUnitRoundoff));
+
+/**
+ * @brief Runs the float32 filter of do_intersect_mixed() on segments given as
+ * float32 columns, kFilterLanes segments at a time on SIMD registers and
+ * without branches.
+ * @param columns The x1, y1, x2 and y2 columns
+ * @param magnitude1 The largest coordinate magnitude of every start point
+ * @param magnitude2 The largest coordinate magnitude of every end point
+ * @param count The number of segments, a multiple of kFilterLanes
+ * @param q The query segment as (x1, y1, x2, y2)
+ * @param results Receives one FilterResult per segment
+ */
+inline void filter_intersect_columns(const float* const* columns, const float* magnitude1, const float* magnitude2,
+                                     size_t count, const float (&q)[4], uint8_t* results) {
+    const float query_magnitude = std::max(std::max(std::abs(q[0]), std::abs(q[1])),
+                                           std::max(std::abs(q[2]), std::abs(q[3])));
+    // Blocks are loaded with memcpy and kept inside this function: passing
+    // them by value would depend on the vector ABI of the target.
+    FloatBlock x1, y1, x2, y2, m1, m2;
+    for (size_t i = 0; i < count; i += kFilterLanes) {
+        std::memcpy(&x1, columns[0] + i, sizeof(FloatBlock));
+        std::memcpy(&y1, columns[1] + i, sizeof(FloatBlock));
+        std::memcpy(&x2, columns[2] + i, sizeof(FloatBlock));
+        std::memcpy(&y2, columns[3] + i, sizeof(FloatBlock));
+        std::memcpy(&m1, magnitude1 + i, sizeof(FloatBlock));
+        std::memcpy(&m2, magnitude2 + i, sizeof(FloatBlock));
+        FloatBlock m = m1 > m2 ? m1 : m2;
+        m = m > query_magnitude ? m : query_magnitude;
+        const FloatBlock threshold = kFloatBatchOrientationFactor * (m * m) + kFloatBatchCollinearTolerance;
+        // The four orientation() determinants, as in filtered_intersect().
+        const FloatBlock o1 = (y2 - y1) * (q[0] - x2) - (x2 - x1) * (q[1] - y2);
+        const FloatBlock o2 = (y2 - y1) * (q[2] - x2) - (x2 - x1) * (q[3] - y2);
+        const FloatBlock o3 = (q[3] - q[1]) * (x1 - q[2]) - (q[2] - q[0]) * (y1 - q[3]);
+        const FloatBlock o4 = (q[3] - q[1]) * (x2 - q[2]) - (q[2] - q[0]) * (y2 - q[3]);
+        // |o| by clearing the sign bit. NaN or infinite values fail the
+        // comparisons and stay ambiguous.
+        const MaskBlock certain = ((FloatBlock)((MaskBlock)o1 & 0x7fffffff) > threshold) &
+                                  ((FloatBlock)((MaskBlock)o2 & 0x7fffffff) > threshold) &
+                                  ((FloatBlock)((MaskBlock)o3 & 0x7fffffff) > threshold) &
+                                  ((FloatBlock)((MaskBlock)o4 & 0x7fffffff) > threshold);
+        const MaskBlock hit = ((o1 > 0) ^ (o2 > 0)) & ((o3 > 0) ^ (o4 > 0));
+        const MaskBlock result = (certain & hit & 1) | (~certain & static_cast<int32_t>(FilterResult::kAmbiguous));
+        const ByteBlock bytes = __builtin_convertvector(result, ByteBlock);
+        std::memcpy(results + i, &bytes, sizeof(ByteBlock));
+    }
+}
+
+/**
+ * @brief Re-evaluates in double the entries the float32 filter left ambiguous.
+ * @return The number of re-evaluated entries
+ */
+template <typename T>
+size_t resolve_ambiguous(const std::vector<LineSegment<T, 2>>& segments, const LineSegment<T, 2>& query,
+                         std::vector<uint8_t>& results) {
+    size_t ambiguous = 0;
+    LineSegment<double, 2> query_double = to_double(query);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (results[i] == static_cast<uint8_t>(FilterResult::kAmbiguous)) {
+            results[i] = do_intersect(to_double(segments[i]), query_double) ? 1 : 0;
+            ++ambiguous;
+        }
+    }
+    return ambiguous;
+}
+
+/**
+ * @brief Tests many segments against one query segment in mixed precision,
+ * with the segments already rounded to float32. This is the fast form when
+ * the same segments are tested against several queries: the float32 filter
+ * only reads the FloatSegments columns, and only the segments it cannot
+ * decide are re-evaluated in double.
+ * @param segments The segments to test
+ * @param batch The same segments rounded to float32
+ * @param query The query segment
+ * @param fallbacks If not null, receives the number of double re-evaluations
+ * @return One entry per segment: 1 if it intersects the query, 0 otherwise
+ * @throws std::invalid_argument if batch does not hold as many segments as segments
+ */
+template <typename T>
+std::vector<uint8_t> do_intersect_mixed(const std::vector<LineSegment<T, 2>>& segments,
+                                        const FloatSegments<2>& batch,
+                                        const LineSegment<T, 2>& query,
+                                        size_t* fallbacks = nullptr) {
+    if (batch.size() != segments.size()) {
+        throw std::invalid_argument("Float batch does not match the segments");
+    }
+    float q[4];
+    to_float(query, q);
+    const float* columns[4] = {batch.column(0), batch.column(1), batch.column(2), batch.column(3)};
+    std::vector<uint8_t> results(batch.padded_size());
+    filter_intersect_columns(columns, batch.magnitude(0), batch.magnitude(1), results.size(), q, results.data());
+    results.resize(segments.size());
+    size_t ambiguous = resolve_ambiguous(segments, query, results);
+    if (fallbacks != nullptr) *fallbacks = ambiguous;
+    return results;
+}
+
+/**
+ * @brief Tests many segments against one query segment in mixed precision.
+ * The segments are rounded to float32 a few hundred at a time while the
+ * filter runs, so one query costs about as much memory traffic as the double
+ * test; the overload taking a FloatSegments is faster for repeated queries.
+ * @param segments The segments to test
+ * @param query The query segment
+ * @param fallbacks If not null, receives the number of double re-evaluations
+ * @return One entry per segment: 1 if it intersects the query, 0 otherwise
+ */
+template <typename T>
+std::vector<uint8_t> do_intersect_mixed(const std::vector<LineSegment<T, 2>>& segments,
+                                        const LineSegment<T, 2>& query,
+                                        size_t* fallbacks = nullptr) {
+    float q[4];
+    to_float(query, q);
+    std::vector<uint8_t> results;
+    filter_staged(segments, results,
+                  [&](const float* const* columns, const float* magnitude1, const float* magnitude2, size_t count,
+                      uint8_t* out) { filter_intersect_columns(columns, magnitude1, magnitude2, count, q, out); });
+    size_t ambiguous = resolve_ambiguous(segments, query, results);
+    if (fallbacks != nullptr) *fallbacks = ambiguous;
+    return results;
+}
+
 } // namespace geometry
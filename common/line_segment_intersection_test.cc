@@ -23,6 +23,24 @@ int main() {
         std::cout << "Intersection point: " << intersection << std::endl;
     }
     std::cout << std::endl;
-    
+
+    // Test case 2: Mixed-precision evaluation, one query against many segments
+    std::vector<LineSegment<double, 2>> segments = {
+        seg2,                                                               // crosses seg1
+        LineSegment<double, 2>(Point<double, 2>(3, 3), Point<double, 2>(4, 4)),  // collinear, disjoint
+        LineSegment<double, 2>(Point<double, 2>(1, 1), Point<double, 2>(5, 1)),  // touches at (1, 1)
+        LineSegment<double, 2>(Point<double, 2>(0, 1), Point<double, 2>(0, 5)),  // well separated
+    };
+    size_t fallbacks = 0;
+    std::vector<uint8_t> results = do_intersect_mixed(segments, seg1, &fallbacks);
+
+    std::cout << "Test 2 - Mixed-precision batch against " << seg1 << ":" << std::endl;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        std::cout << "Segment " << segments[i] << " intersects? " << (results[i] ? "Yes" : "No")
+                  << " (double: " << (do_intersect(segments[i], seg1) ? "Yes" : "No") << ")" << std::endl;
+    }
+    std::cout << "Re-evaluated in double: " << fallbacks << " of " << segments.size() << std::endl;
+    std::cout << std::endl;
+
     return 0;
 }
\ No newline at end of file
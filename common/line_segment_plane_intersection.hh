@@ -3,6 +3,13 @@
 #pragma once
 
 #include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "common/float_filter.hh"
 #include "common/point.hh"
 #include "common/line_segment.hh"
 #include "common/plane.hh"
@@ -91,8 +98,7 @@ Point<T, 3> intersection_point(const LineSegment<T, 3>& segment, const Plane<T>&
     T t = -dist1 / denominator;
     
     // Calculate the intersection point
-    Point<T, 3> scaled_direction(direction.x() * t, direction.y() * t, direction.z() * t);
-    Point<T, 3> intersection = p1 + scaled_direction;
+    Point<T, 3> intersection = p1 + direction * t;
     
     return intersection;
 }
@@ -131,30 +137,271 @@ std::string intersection_type(const LineSegment<T, 3>& segment, const Plane<T>&
     return "no_intersection";
 }
 
+// --- Mixed-precision evaluation ---
+//
+// As for the 2D segment tests in line_segment_intersection.hh, the distances
+// of the endpoints to the plane are first computed in float32 with an error
+// bound, and only segments that cannot be decided that way are re-evaluated in
+// double.
+
+// Error bound of a float32 point-to-plane distance relative to S, the sum of
+// the largest coordinate magnitudes of the point and of the plane's point.
+// With a unit normal, rounding the inputs to float and the float operations
+// contribute at most 21 u S; 32 u also covers the rounding of the double
+// evaluation.
+constexpr double kFloatPlaneDistanceErrorFactor = 32.0 * kFloatUnitRoundoff;
+
+/**
+ * @brief A plane rounded to float32, for the mixed-precision filter.
+ */
+struct FloatPlane {
+    float point[3];
+    float normal[3];
+    float magnitude;  // Largest coordinate magnitude of point
+};
+
+/**
+ * @brief Rounds a plane to float32.
+ */
+template <typename T>
+FloatPlane to_float(const Plane<T>& plane) {
+    FloatPlane result;
+    result.magnitude = 0.0f;
+    for (size_t i = 0; i < 3; ++i) {
+        result.point[i] = static_cast<float>(plane.point()[i]);
+        result.normal[i] = static_cast<float>(plane.normal()[i]);
+        result.magnitude = std::max(result.magnitude, std::abs(result.point[i]));
+    }
+    return result;
+}
+
+/**
+ * @brief Classifies one endpoint distance computed in float32.
+ * @return 1 or -1 if the point is certainly farther than tolerance on the
+ * positive or negative side, 0 if it is certainly within tolerance, and 2 if
+ * it cannot be decided in float32
+ */
+inline int filtered_plane_side(float distance, double bound, double tolerance) {
+    double d = distance;
+    // Written so that NaN or infinite values fall through to 2.
+    if (std::abs(d) + bound < tolerance) return 0;
+    if (std::abs(d) - bound > tolerance) return (d > 0) ? 1 : -1;
+    return 2;
+}
+
+/**
+ * @brief Runs the float32 filter on the endpoints of a segment.
+ * @return kIntersection / kNoIntersection when certain, kAmbiguous otherwise
+ */
+inline FilterResult filtered_intersect(const float (&p1)[3], const float (&p2)[3],
+                                       const FloatPlane& plane, double tolerance) {
+    float dist1 = 0.0f, dist2 = 0.0f;
+    float magnitude1 = 0.0f, magnitude2 = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        dist1 += plane.normal[i] * (p1[i] - plane.point[i]);
+        dist2 += plane.normal[i] * (p2[i] - plane.point[i]);
+        magnitude1 = std::max(magnitude1, std::abs(p1[i]));
+        magnitude2 = std::max(magnitude2, std::abs(p2[i]));
+    }
+    int side1 = filtered_plane_side(dist1, kFloatPlaneDistanceErrorFactor * (magnitude1 + plane.magnitude), tolerance);
+    int side2 = filtered_plane_side(dist2, kFloatPlaneDistanceErrorFactor * (magnitude2 + plane.magnitude), tolerance);
+
+    if (side1 == 0 || side2 == 0) return FilterResult::kIntersection;
+    if (side1 == 2 || side2 == 2) return FilterResult::kAmbiguous;
+    return (side1 == side2) ? FilterResult::kNoIntersection : FilterResult::kIntersection;
+}
+
+/**
+ * @brief Rounds a 3D point to float32.
+ */
+template <typename T>
+void to_float(const Point<T, 3>& p, float (&out)[3]) {
+    for (size_t i = 0; i < 3; ++i) {
+        out[i] = static_cast<float>(p[i]);
+    }
+}
+
+/**
+ * @brief Same test as do_intersect(segment, plane), with the distances
+ * evaluated in double regardless of T.
+ */
+template <typename T>
+bool do_intersect_double(const LineSegment<T, 3>& segment, const Plane<T>& plane, double tolerance) {
+    double dist1 = 0.0, dist2 = 0.0;
+    for (size_t i = 0; i < 3; ++i) {
+        double n = plane.normal()[i];
+        dist1 += n * (static_cast<double>(segment.start()[i]) - static_cast<double>(plane.point()[i]));
+        dist2 += n * (static_cast<double>(segment.end()[i]) - static_cast<double>(plane.point()[i]));
+    }
+    if (std::abs(dist1) > tolerance && std::abs(dist2) > tolerance) {
+        if ((dist1 > 0 && dist2 > 0) || (dist1 < 0 && dist2 < 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
- * @brief Calculates the dot product of two 3D vectors.
- * @param a First vector
- * @param b Second vector
- * @return The dot product
+ * @brief Determines if a line segment intersects a plane, evaluating in float32 first.
+ * Gives the same answer as do_intersect() evaluated in double.
+ * @param segment The line segment to test
+ * @param plane The plane to test intersection with
+ * @param tolerance The tolerance for considering points on the plane
+ * @return true if the segment intersects the plane, false otherwise
  */
 template <typename T>
-T dot_product(const Point<T, 3>& a, const Point<T, 3>& b) {
-    return a.x() * b.x() + a.y() * b.y() + a.z() * b.z();
+bool do_intersect_mixed(const LineSegment<T, 3>& segment, const Plane<T>& plane, T tolerance = 1e-9) {
+    float p1[3], p2[3];
+    to_float(segment.start(), p1);
+    to_float(segment.end(), p2);
+    FilterResult result = filtered_intersect(p1, p2, to_float(plane), tolerance);
+    if (result != FilterResult::kAmbiguous) {
+        return result == FilterResult::kIntersection;
+    }
+    return do_intersect_double(segment, plane, tolerance);
+}
+
+// Threshold factor of the batch filter, which computes the error bound in
+// float32 as well: 33 u S stays above 32 u S after the two roundings of the
+// bound. The tolerance is moved 8 u away from the point being decided on
+// either side, which covers rounding it and the comparison sums to float32.
+constexpr float kFloatBatchPlaneDistanceFactor = static_cast<float>(33.0 * kFloatUnitRoundoff);
+
+/**
+ * @brief Runs the float32 filter of do_intersect_mixed() on segments given as
+ * float32 columns, kFilterLanes segments at a time on SIMD registers and
+ * without branches.
+ * @param columns The x1, y1, z1, x2, y2 and z2 columns
+ * @param start_magnitudes The largest coordinate magnitude of every start point
+ * @param end_magnitudes The largest coordinate magnitude of every end point
+ * @param count The number of segments, a multiple of kFilterLanes
+ * @param p The plane rounded to float32
+ * @param below The tolerance rounded down for the on-plane test
+ * @param above The tolerance rounded up for the off-plane test
+ * @param results Receives one FilterResult per segment
+ */
+inline void filter_plane_columns(const float* const* columns, const float* start_magnitudes,
+                                 const float* end_magnitudes, size_t count, const FloatPlane& p, float below,
+                                 float above, uint8_t* results) {
+    // Blocks are loaded with memcpy and kept inside this function: passing
+    // them by value would depend on the vector ABI of the target.
+    FloatBlock x1, y1, z1, x2, y2, z2, magnitude1, magnitude2;
+    for (size_t i = 0; i < count; i += kFilterLanes) {
+        std::memcpy(&x1, columns[0] + i, sizeof(FloatBlock));
+        std::memcpy(&y1, columns[1] + i, sizeof(FloatBlock));
+        std::memcpy(&z1, columns[2] + i, sizeof(FloatBlock));
+        std::memcpy(&x2, columns[3] + i, sizeof(FloatBlock));
+        std::memcpy(&y2, columns[4] + i, sizeof(FloatBlock));
+        std::memcpy(&z2, columns[5] + i, sizeof(FloatBlock));
+        std::memcpy(&magnitude1, start_magnitudes + i, sizeof(FloatBlock));
+        std::memcpy(&magnitude2, end_magnitudes + i, sizeof(FloatBlock));
+        // The endpoint distances, summed in the order of filtered_intersect().
+        const FloatBlock dist1 = p.normal[0] * (x1 - p.point[0]) + p.normal[1] * (y1 - p.point[1]) +
+                                 p.normal[2] * (z1 - p.point[2]);
+        const FloatBlock dist2 = p.normal[0] * (x2 - p.point[0]) + p.normal[1] * (y2 - p.point[1]) +
+                                 p.normal[2] * (z2 - p.point[2]);
+        const FloatBlock bound1 = kFloatBatchPlaneDistanceFactor * (magnitude1 + p.magnitude);
+        const FloatBlock bound2 = kFloatBatchPlaneDistanceFactor * (magnitude2 + p.magnitude);
+        // |dist| by clearing the sign bit. NaN or infinite values fail every
+        // comparison and stay ambiguous.
+        const FloatBlock abs1 = (FloatBlock)((MaskBlock)dist1 & 0x7fffffff);
+        const FloatBlock abs2 = (FloatBlock)((MaskBlock)dist2 & 0x7fffffff);
+        // Certainly within tolerance of the plane, or certainly farther.
+        const MaskBlock on1 = abs1 + bound1 < below;
+        const MaskBlock on2 = abs2 + bound2 < below;
+        const MaskBlock off = (abs1 - bound1 > above) & (abs2 - bound2 > above);
+        const MaskBlock crosses = (dist1 > 0) ^ (dist2 > 0);
+        const MaskBlock hit = on1 | on2 | (off & crosses);
+        const MaskBlock miss = off & ~crosses;
+        const MaskBlock result = (hit & 1) | (~(hit | miss) & static_cast<int32_t>(FilterResult::kAmbiguous));
+        const ByteBlock bytes = __builtin_convertvector(result, ByteBlock);
+        std::memcpy(results + i, &bytes, sizeof(ByteBlock));
+    }
 }
 
 /**
- * @brief Calculates the cross product of two 3D vectors.
- * @param a First vector
- * @param b Second vector
- * @return The cross product vector
+ * @brief Re-evaluates in double the entries the float32 filter left ambiguous.
+ * @return The number of re-evaluated entries
+ */
+template <typename T>
+size_t resolve_ambiguous(const std::vector<LineSegment<T, 3>>& segments, const Plane<T>& plane, double tolerance,
+                         std::vector<uint8_t>& results) {
+    size_t ambiguous = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (results[i] == static_cast<uint8_t>(FilterResult::kAmbiguous)) {
+            results[i] = do_intersect_double(segments[i], plane, tolerance) ? 1 : 0;
+            ++ambiguous;
+        }
+    }
+    return ambiguous;
+}
+
+/**
+ * @brief Tests many segments against one plane in mixed precision, with the
+ * segments already rounded to float32. This is the fast form when the same
+ * segments are tested against several planes: the float32 filter only reads
+ * the FloatSegments columns, and only the segments it cannot decide are
+ * re-evaluated in double.
+ * @param segments The segments to test
+ * @param batch The same segments rounded to float32
+ * @param plane The plane to test against
+ * @param fallbacks If not null, receives the number of double re-evaluations
+ * @param tolerance The tolerance for considering points on the plane
+ * @return One entry per segment: 1 if it intersects the plane, 0 otherwise
+ * @throws std::invalid_argument if batch does not hold as many segments as segments
+ */
+template <typename T>
+std::vector<uint8_t> do_intersect_mixed(const std::vector<LineSegment<T, 3>>& segments,
+                                        const FloatSegments<3>& batch,
+                                        const Plane<T>& plane,
+                                        size_t* fallbacks = nullptr,
+                                        T tolerance = 1e-9) {
+    if (batch.size() != segments.size()) {
+        throw std::invalid_argument("Float batch does not match the segments");
+    }
+    const float below = static_cast<float>(tolerance * (1.0 - 8.0 * kFloatUnitRoundoff));
+    const float above = static_cast<float>(tolerance * (1.0 + 8.0 * kFloatUnitRoundoff));
+    const float* columns[6];
+    for (size_t c = 0; c < 6; ++c) {
+        columns[c] = batch.column(c);
+    }
+    std::vector<uint8_t> results(batch.padded_size());
+    filter_plane_columns(columns, batch.magnitude(0), batch.magnitude(1), results.size(), to_float(plane), below,
+                         above, results.data());
+    results.resize(segments.size());
+    size_t ambiguous = resolve_ambiguous(segments, plane, tolerance, results);
+    if (fallbacks != nullptr) *fallbacks = ambiguous;
+    return results;
+}
+
+/**
+ * @brief Tests many segments against one plane in mixed precision.
+ * The segments are rounded to float32 a few hundred at a time while the
+ * filter runs, so one plane costs about as much memory traffic as the double
+ * test; the overload taking a FloatSegments is faster for repeated planes.
+ * @param segments The segments to test
+ * @param plane The plane to test against
+ * @param fallbacks If not null, receives the number of double re-evaluations
+ * @param tolerance The tolerance for considering points on the plane
+ * @return One entry per segment: 1 if it intersects the plane, 0 otherwise
  */
 template <typename T>
-Point<T, 3> cross_product(const Point<T, 3>& a, const Point<T, 3>& b) {
-    return Point<T, 3>(
-        a.y() * b.z() - a.z() * b.y(),
-        a.z() * b.x() - a.x() * b.z(),
-        a.x() * b.y() - a.y() * b.x()
-    );
+std::vector<uint8_t> do_intersect_mixed(const std::vector<LineSegment<T, 3>>& segments,
+                                        const Plane<T>& plane,
+                                        size_t* fallbacks = nullptr,
+                                        T tolerance = 1e-9) {
+    const FloatPlane p = to_float(plane);
+    const float below = static_cast<float>(tolerance * (1.0 - 8.0 * kFloatUnitRoundoff));
+    const float above = static_cast<float>(tolerance * (1.0 + 8.0 * kFloatUnitRoundoff));
+    std::vector<uint8_t> results;
+    filter_staged(segments, results,
+                  [&](const float* const* columns, const float* start_magnitudes, const float* end_magnitudes,
+                      size_t count, uint8_t* out) {
+                      filter_plane_columns(columns, start_magnitudes, end_magnitudes, count, p, below, above, out);
+                  });
+    size_t ambiguous = resolve_ambiguous(segments, plane, tolerance, results);
+    if (fallbacks != nullptr) *fallbacks = ambiguous;
+    return results;
 }
 
 } // namespace geometry
@@ -78,6 +78,19 @@ int main() {
         Point<double, 3> intersection = intersection_point(segment5, xy_plane);
         std::cout << "Intersection point: " << intersection << std::endl;
     }
-    
+    std::cout << std::endl;
+
+    // Test case 6: Mixed-precision evaluation of all segments above
+    std::vector<LineSegment<double, 3>> segments = {segment1, segment2, segment3, segment4, segment5};
+    size_t fallbacks = 0;
+    std::vector<uint8_t> results = do_intersect_mixed(segments, xy_plane, &fallbacks);
+
+    std::cout << "Test 6 - Mixed-precision batch:" << std::endl;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        std::cout << "Segment " << segments[i] << " intersects? " << (results[i] ? "Yes" : "No")
+                  << " (double: " << (do_intersect(segments[i], xy_plane) ? "Yes" : "No") << ")" << std::endl;
+    }
+    std::cout << "Re-evaluated in double: " << fallbacks << " of " << segments.size() << std::endl;
+
     return 0;
 }
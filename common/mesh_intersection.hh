@@ -0,0 +1,131 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "common/facet_bvh.hh"
+#include "common/surface.hh"
+#include "common/thread_pool.hh"
+#include "common/triangle_intersection.hh"
+
+namespace geometry {
+
+/**
+ * @brief Finds all intersecting facet pairs of two triangle meshes.
+ *
+ * Traverses the two hierarchies simultaneously, starting from the pair of
+ * roots. A pair of nodes whose boxes overlap is refined by splitting the
+ * larger inner node; pairs of leaves run the exact triangle/triangle test on
+ * their facets. Near the roots the two child pairs are submitted to the pool
+ * as a nested batch, so idle threads steal whole subtrees; below that depth
+ * a thread walks its subtree alone.
+ *
+ * @param a First surface
+ * @param bvh_a Hierarchy over the facets of a
+ * @param b Second surface
+ * @param bvh_b Hierarchy over the facets of b
+ * @param executor Pool and number of threads
+ * @param tolerance Tolerance of the triangle/triangle test
+ * @return Pairs (facet of a, facet of b) that intersect, sorted
+ */
+template <typename T>
+std::vector<std::pair<uint32_t, uint32_t>> intersecting_facet_pairs(
+        const Surface<T, 3>& a, const FacetBvh<T>& bvh_a,
+        const Surface<T, 3>& b, const FacetBvh<T>& bvh_b,
+        Executor executor = Executor(),
+        T tolerance = 1e-9) {
+    using NodePair = std::pair<uint32_t, uint32_t>;
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    if (bvh_a.empty() || bvh_b.empty()) return result;
+
+    // Splitting up to this depth leaves about 16 subtrees per thread, enough
+    // to even out the unbalanced ones.
+    size_t parallel_depth = 0;
+    if (executor.num_threads() > 1) {
+        while ((size_t{1} << parallel_depth) < 16 * executor.num_threads()) ++parallel_depth;
+    }
+    std::mutex result_mutex;
+
+    auto half_area = [](const BoundingBox<T, 3>& box) {
+        return box.extent(0) * box.extent(1) + box.extent(1) * box.extent(2) + box.extent(2) * box.extent(0);
+    };
+
+    // Walks the subtree of a node pair, processing one child pair directly
+    // and the other one after it, or both as pool tasks while depth is small.
+    auto process = [&](auto& self, NodePair pair, size_t depth) -> void {
+        std::vector<NodePair> stack;
+        std::vector<std::pair<uint32_t, uint32_t>> found;
+        while (true) {
+            const auto& na = bvh_a.nodes()[pair.first];
+            const auto& nb = bvh_b.nodes()[pair.second];
+            const bool leaf_a = FacetBvh<T>::is_leaf(na);
+            const bool leaf_b = FacetBvh<T>::is_leaf(nb);
+            if (!na.bounds.intersects(nb.bounds)) {
+                // Nothing below this pair.
+            } else if (leaf_a && leaf_b) {
+                for (uint32_t i = na.first; i < na.first + na.count; ++i) {
+                    for (uint32_t j = nb.first; j < nb.first + nb.count; ++j) {
+                        if (!bvh_a.facet_bounds()[i].intersects(bvh_b.facet_bounds()[j])) continue;
+                        uint32_t fa = bvh_a.facets()[i];
+                        uint32_t fb = bvh_b.facets()[j];
+                        if (do_intersect(a.facets[fa], b.facets[fb], tolerance)) {
+                            found.emplace_back(fa, fb);
+                        }
+                    }
+                }
+            } else {
+                // Split the inner node with the larger box.
+                NodePair first, second;
+                if (leaf_b || (!leaf_a && half_area(na.bounds) >= half_area(nb.bounds))) {
+                    first = NodePair(FacetBvh<T>::left_child(pair.first), pair.second);
+                    second = NodePair(bvh_a.right_child(pair.first), pair.second);
+                } else {
+                    first = NodePair(pair.first, FacetBvh<T>::left_child(pair.second));
+                    second = NodePair(pair.first, bvh_b.right_child(pair.second));
+                }
+                if (depth < parallel_depth) {
+                    executor.pool().run(2, [&](size_t k) { self(self, k == 0 ? first : second, depth + 1); });
+                } else {
+                    stack.push_back(second);
+                    pair = first;
+                    continue;
+                }
+            }
+            if (stack.empty()) break;
+            pair = stack.back();
+            stack.pop_back();
+        }
+        if (!found.empty()) {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            result.insert(result.end(), found.begin(), found.end());
+        }
+    };
+
+    process(process, NodePair(0, 0), 0);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * @brief Finds all intersecting facet pairs of two triangle meshes, building
+ * the facet hierarchies first.
+ * @param a First surface
+ * @param b Second surface
+ * @param executor Pool and number of threads for building and traversal
+ * @return Pairs (facet of a, facet of b) that intersect, sorted
+ */
+template <typename T>
+std::vector<std::pair<uint32_t, uint32_t>> intersecting_facet_pairs(
+        const Surface<T, 3>& a, const Surface<T, 3>& b,
+        Executor executor = Executor()) {
+    FacetBvh<T> bvh_a(a, executor);
+    FacetBvh<T> bvh_b(b, executor);
+    return intersecting_facet_pairs(a, bvh_a, b, bvh_b, executor);
+}
+
+} // namespace geometry
@@ -0,0 +1,41 @@
+// Times facet hierarchy construction and mesh/mesh intersection for two
+// overlapping spheres of about N triangles each, for 1, 2, 4, ... threads and
+// the hardware concurrency.
+//
+// Usage: mesh_intersection_benchmark [triangles per mesh, default 1000000]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "benchmark_timing.hh"
+#include "mesh_intersection.hh"
+#include "test_meshes.hh"
+
+int main(int argc, char** argv) {
+    using namespace geometry;
+
+    const size_t triangles = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t stacks = std::max<size_t>(2, static_cast<size_t>(std::sqrt(triangles / 4.0)));
+    Surface<double, 3> a = triangulated_sphere(Point<double, 3>(0, 0, 0), 1.0, stacks, 2 * stacks);
+    Surface<double, 3> b = triangulated_sphere(Point<double, 3>(1.0, 0.3, 0.1), 0.9, stacks, 2 * stacks);
+    std::cout << a << " vs " << b << std::endl;
+
+    double baseline = 0;
+    for_each_thread_count(std::thread::hardware_concurrency(), [&](size_t threads) {
+        auto start = std::chrono::steady_clock::now();
+        FacetBvh<double> bvh_a(a, threads);
+        FacetBvh<double> bvh_b(b, threads);
+        double build = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t pairs = intersecting_facet_pairs(a, bvh_a, b, bvh_b, threads).size();
+        double query = seconds_since(start);
+        if (threads == 1) baseline = query;
+
+        std::cout << threads << " threads: build " << build << " s, traversal " << query << " s ("
+                  << pairs << " pairs, speedup " << baseline / query << ")" << std::endl;
+    });
+    return 0;
+}
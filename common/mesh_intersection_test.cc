@@ -0,0 +1,39 @@
+#include <cmath>
+#include <iostream>
+#include "mesh_intersection.hh"
+#include "test_meshes.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Single triangle pairs
+    Simplex<double, 3> t1({Point<double, 3>(0, 0, 0), Point<double, 3>(2, 0, 0), Point<double, 3>(0, 2, 0)});
+    Simplex<double, 3> piercing({Point<double, 3>(0.5, 0.5, -1), Point<double, 3>(0.5, 0.5, 1), Point<double, 3>(1, 1, 1)});
+    Simplex<double, 3> above({Point<double, 3>(0, 0, 1), Point<double, 3>(2, 0, 1), Point<double, 3>(0, 2, 1)});
+    Simplex<double, 3> coplanar({Point<double, 3>(1, 1, 0), Point<double, 3>(3, 1, 0), Point<double, 3>(1, 3, 0)});
+    Simplex<double, 3> touching({Point<double, 3>(2, 0, 0), Point<double, 3>(3, 0, 1), Point<double, 3>(3, 0, -1)});
+    std::cout << "Test 1 - Triangle/triangle:" << std::endl;
+    std::cout << "Piercing triangles intersect? " << (do_intersect(t1, piercing) ? "Yes" : "No") << std::endl;
+    std::cout << "Parallel triangles intersect? " << (do_intersect(t1, above) ? "Yes" : "No") << std::endl;
+    std::cout << "Overlapping coplanar triangles intersect? " << (do_intersect(t1, coplanar) ? "Yes" : "No") << std::endl;
+    std::cout << "Triangles touching at a vertex intersect? " << (do_intersect(t1, touching) ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: Two overlapping spheres against brute force
+    Surface<double, 3> a = triangulated_sphere(Point<double, 3>(0, 0, 0), 1.0, 24, 48);
+    Surface<double, 3> b = triangulated_sphere(Point<double, 3>(1.2, 0.1, 0.05), 0.8, 20, 40);
+    std::vector<std::pair<uint32_t, uint32_t>> pairs = intersecting_facet_pairs(a, b, 4);
+
+    std::vector<std::pair<uint32_t, uint32_t>> expected;
+    for (uint32_t i = 0; i < a.num_facets(); ++i) {
+        for (uint32_t j = 0; j < b.num_facets(); ++j) {
+            if (do_intersect(a.facets[i], b.facets[j])) expected.emplace_back(i, j);
+        }
+    }
+    std::cout << "Test 2 - Mesh/mesh:" << std::endl;
+    std::cout << a << " vs " << b << std::endl;
+    std::cout << "Intersecting facet pairs: " << pairs.size() << std::endl;
+    std::cout << "Matches brute force? " << (pairs == expected ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Times the mixed-precision batch tests against the plain double tests on
+// mostly well-separated random data: 2D segments against a query segment and
+// 3D segments against a plane. For each, reports the double loop, the batch
+// test including the conversion to float32 columns, and the batch test on a
+// prebuilt FloatSegments, with the speedup over double, the number of double
+// fallbacks and the number of answers that differ from double (must be 0).
+//
+// Usage: mixed_precision_benchmark [segments, default 4000000] [repetitions, default 5]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchmark_timing.hh"
+#include "line_segment_intersection.hh"
+#include "line_segment_plane_intersection.hh"
+
+namespace {
+
+// Best time of several runs of a kernel.
+double best_of(size_t repetitions, const std::function<void()>& kernel) {
+    double best = 0;
+    for (size_t r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        kernel();
+        double elapsed = geometry::seconds_since(start);
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+size_t mismatches(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    size_t count = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        count += a[i] != b[i];
+    }
+    return count;
+}
+
+void report(const std::string& name, double seconds, double baseline, size_t fallbacks, size_t wrong) {
+    std::cout << "  " << name << ": " << seconds << " s, speedup " << baseline / seconds << ", fallbacks "
+              << fallbacks << ", mismatches " << wrong << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    using namespace geometry;
+
+    const size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+    const size_t repetitions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+    std::mt19937 rng(28);
+    std::uniform_real_distribution<double> coordinate(-100, 100);
+    std::uniform_real_distribution<double> step(-1, 1);
+
+    std::vector<LineSegment<double, 2>> segments2(n);
+    for (auto& s : segments2) {
+        Point<double, 2> start(coordinate(rng), coordinate(rng));
+        s = LineSegment<double, 2>(start, start + Point<double, 2>(step(rng), step(rng)));
+    }
+    const LineSegment<double, 2> query(Point<double, 2>(-90, -80), Point<double, 2>(85, 95));
+    std::vector<uint8_t> expected2(n), found2;
+    size_t fallbacks2 = 0;
+    std::cout << n << " 2D segments against a segment:" << std::endl;
+    double double2 = best_of(repetitions, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            expected2[i] = do_intersect(segments2[i], query);
+        }
+    });
+    report("double", double2, double2, 0, 0);
+    double mixed2 = best_of(repetitions, [&] { found2 = do_intersect_mixed(segments2, query, &fallbacks2); });
+    report("mixed with conversion", mixed2, double2, fallbacks2, mismatches(found2, expected2));
+    FloatSegments<2> batch2(segments2);
+    double prebuilt2 = best_of(repetitions, [&] { found2 = do_intersect_mixed(segments2, batch2, query, &fallbacks2); });
+    report("mixed on FloatSegments", prebuilt2, double2, fallbacks2, mismatches(found2, expected2));
+
+    std::vector<LineSegment<double, 3>> segments3(n);
+    for (auto& s : segments3) {
+        Point<double, 3> start(coordinate(rng), coordinate(rng), coordinate(rng));
+        s = LineSegment<double, 3>(start, start + Point<double, 3>(step(rng), step(rng), step(rng)));
+    }
+    const Plane<double> plane(Point<double, 3>(1, 2, 3), Point<double, 3>(1, -2, 0.5));
+    std::vector<uint8_t> expected3(n), found3;
+    size_t fallbacks3 = 0;
+    std::cout << n << " 3D segments against a plane:" << std::endl;
+    double double3 = best_of(repetitions, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            expected3[i] = do_intersect(segments3[i], plane);
+        }
+    });
+    report("double", double3, double3, 0, 0);
+    double mixed3 = best_of(repetitions, [&] { found3 = do_intersect_mixed(segments3, plane, &fallbacks3); });
+    report("mixed with conversion", mixed3, double3, fallbacks3, mismatches(found3, expected3));
+    FloatSegments<3> batch3(segments3);
+    double prebuilt3 = best_of(repetitions, [&] { found3 = do_intersect_mixed(segments3, batch3, plane, &fallbacks3); });
+    report("mixed on FloatSegments", prebuilt3, double3, fallbacks3, mismatches(found3, expected3));
+    return 0;
+}
@@ -0,0 +1,28 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "common/thread_pool.hh"
+
+namespace geometry {
+
+/**
+ * @brief Splits [0, n) into one contiguous run per thread of the executor and
+ * calls fn(begin, end) for each run on its pool, or directly on the calling
+ * thread when there is only one run.
+ */
+template <typename Fn>
+void for_each_run(size_t n, const Executor& executor, Fn fn) {
+    const size_t num_runs = std::max<size_t>(1, std::min(executor.num_threads(), n));
+    if (num_runs == 1) {
+        fn(size_t{0}, n);
+        return;
+    }
+    const size_t chunk = (n + num_runs - 1) / num_runs;
+    executor.pool().run((n + chunk - 1) / chunk, [&](size_t run) { fn(run * chunk, std::min(n, (run + 1) * chunk)); });
+}
+
+} // namespace geometry
@@ -117,35 +117,11 @@ private:
      * @return The normalized vector
      */
     static Point<T, 3> normalize(const Point<T, 3>& v) {
-        T magnitude = std::sqrt(v.x() * v.x() + v.y() * v.y() + v.z() * v.z());
+        T magnitude = norm(v);
         if (magnitude < 1e-9) {
             throw std::invalid_argument("Cannot normalize zero vector");
         }
-        return Point<T, 3>(v.x() / magnitude, v.y() / magnitude, v.z() / magnitude);
-    }
-
-    /**
-     * @brief Calculate the dot product of two 3D vectors.
-     * @param a First vector
-     * @param b Second vector
-     * @return The dot product
-     */
-    static T dot_product(const Point<T, 3>& a, const Point<T, 3>& b) {
-        return a.x() * b.x() + a.y() * b.y() + a.z() * b.z();
-    }
-
-    /**
-     * @brief Calculate the cross product of two 3D vectors.
-     * @param a First vector
-     * @param b Second vector
-     * @return The cross product vector
-     */
-    static Point<T, 3> cross_product(const Point<T, 3>& a, const Point<T, 3>& b) {
-        return Point<T, 3>(
-            a.y() * b.z() - a.z() * b.y(),
-            a.z() * b.x() - a.x() * b.z(),
-            a.x() * b.y() - a.y() * b.x()
-        );
+        return scale(v, 1 / magnitude);
     }
 };
 
@@ -3,74 +3,249 @@
 #pragma once
 
 #include <array>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
 
 namespace geometry {
 
 template <typename T, size_t Dim>
-class Point {
+class Point;
+
+/**
+ * @brief Storage layout of Point<T, Dim>: number of allocated lanes and the
+ * alignment of the coordinate block. Lanes past Dim are padding and are kept
+ * at zero. The SIMD specializations live in simd_point.hh.
+ */
+template <typename T, size_t Dim>
+struct PointLayout {
+  static constexpr size_t kLanes = Dim;
+  static constexpr size_t kAlignment = alignof(T);
+};
+
+/**
+ * @brief Register operations for the SIMD layout of Point<T, Dim>; disabled
+ * unless simd_point.hh specializes it. When enabled, every expression node
+ * has a lanes() member that evaluates it as a register, so an expression
+ * such as a - b + c * s is still evaluated once, when it is assigned to a
+ * Point, but with one instruction per node instead of a loop.
+ */
+template <typename T, size_t Dim>
+struct SimdLanes {
+  static constexpr bool kEnabled = false;
+  static constexpr bool kHasCross = false;
+};
+
+/**
+ * @brief CRTP base for everything that can be read coordinate by coordinate
+ * like a Point<T, Dim>: points themselves and the lazy arithmetic nodes below.
+ * An expression such as a - b + c * s builds a small tree of nodes and is only
+ * evaluated, in a single loop and without temporaries, when it is assigned to
+ * a Point.
+ */
+template <typename E, typename T, size_t Dim>
+class PointExpression {
+public:
+  constexpr const E& self() const { return static_cast<const E&>(*this); }
+
+  constexpr T operator[](size_t index) const { return self()[index]; }
+
+  static constexpr size_t dimension() { return Dim; }
+};
+
+// Points are held by reference inside an expression, intermediate nodes by
+// value. Do not keep an expression (e.g. via auto) beyond the statement that
+// built it if any of its operands is a temporary Point.
+template <typename E>
+struct ExpressionOperand {
+  using type = const E;
+};
+
+template <typename T, size_t Dim>
+struct ExpressionOperand<Point<T, Dim>> {
+  using type = const Point<T, Dim>&;
+};
+
+template <typename T, size_t Dim>
+class Point : public PointExpression<Point<T, Dim>, T, Dim> {
 public:
-  Point(): coordinates_{} {};
+  constexpr Point(): coordinates_{} {};
 
-  template <typename... Args>
-    Point(Args... args): coordinates_{static_cast<T>(args)...} {
+  template <typename... Args,
+            typename = std::enable_if_t<(std::is_arithmetic_v<Args> && ...)>>
+    constexpr Point(Args... args): coordinates_{static_cast<T>(args)...} {
       static_assert(sizeof...(Args) == Dim, "Incorrect number of initializers for Point");
     }
 
-  const T x() const { return coordinates_.at(0); }
-  const T y() const { return coordinates_.at(1); }
+  // Evaluates an arithmetic expression of points in one pass.
+  template <typename E>
+  constexpr Point(const PointExpression<E, T, Dim>& expression): coordinates_{} {
+    assign(expression.self());
+  }
+
+  // Every expression node is component-wise, so assigning an expression that
+  // refers to *this (e.g. p = q - p) is safe.
+  template <typename E>
+  constexpr Point& operator=(const PointExpression<E, T, Dim>& expression) {
+    assign(expression.self());
+    return *this;
+  }
 
-  const T& z() const { 
+  template <typename E>
+  constexpr Point& operator+=(const PointExpression<E, T, Dim>& expression) {
+    assign(*this + expression.self());
+    return *this;
+  }
+
+  template <typename E>
+  constexpr Point& operator-=(const PointExpression<E, T, Dim>& expression) {
+    assign(*this - expression.self());
+    return *this;
+  }
+
+  constexpr Point& operator*=(T factor) {
+    for (size_t i = 0; i < Dim; ++i) {
+      coordinates_[i] *= factor;
+    }
+    return *this;
+  }
+
+  // Unchecked accessors; the dimension is validated at compile time.
+  constexpr const T& x() const { return coordinates_[0]; }
+
+  constexpr const T& y() const {
+    static_assert(Dim >= 2, "y() only available for 2D and higher points");
+    return coordinates_[1];
+  }
+
+  constexpr const T& z() const {
     static_assert(Dim >= 3, "z() only available for 3D points");
-    return coordinates_.at(2); 
+    return coordinates_[2];
   }
 
-  T& operator[](size_t index) { return coordinates_[index]; }
-  const T& operator[](size_t index) const { return coordinates_[index]; }
+  constexpr T& operator[](size_t index) { return coordinates_[index]; }
+  constexpr const T& operator[](size_t index) const { return coordinates_[index]; }
+
+  // Raw coordinate block, PointLayout<T, Dim>::kLanes wide.
+  constexpr T* data() { return coordinates_.data(); }
+  constexpr const T* data() const { return coordinates_.data(); }
+
+  static constexpr size_t dimension() { return Dim; }
+
+  // The coordinates in a register; only for SIMD layouts.
+  auto lanes() const { return SimdLanes<T, Dim>::load(coordinates_.data()); }
+
+private:
+  alignas(PointLayout<T, Dim>::kAlignment) std::array<T, PointLayout<T, Dim>::kLanes> coordinates_;
+
+  // Evaluates an expression into the coordinates, in registers when the
+  // layout has SIMD lanes and this is not a constant evaluation.
+  template <typename E>
+  constexpr void assign(const E& expression) {
+    if constexpr (SimdLanes<T, Dim>::kEnabled) {
+      if (!__builtin_is_constant_evaluated()) {
+        SimdLanes<T, Dim>::store(coordinates_.data(), expression.lanes());
+        return;
+      }
+    }
+    for (size_t i = 0; i < Dim; ++i) {
+      coordinates_[i] = expression[i];
+    }
+  }
+};
+
+// --- Expression nodes ---
+
+template <typename L, typename R, typename T, size_t Dim>
+class PointSum : public PointExpression<PointSum<L, R, T, Dim>, T, Dim> {
+public:
+  constexpr PointSum(const L& lhs, const R& rhs): lhs_(lhs), rhs_(rhs) {}
+
+  constexpr T operator[](size_t index) const { return lhs_[index] + rhs_[index]; }
 
-  constexpr size_t dimension() const { return Dim; }
+  auto lanes() const { return SimdLanes<T, Dim>::add(lhs_.lanes(), rhs_.lanes()); }
 
 private:
-  std::array<T, Dim> coordinates_;
+  typename ExpressionOperand<L>::type lhs_;
+  typename ExpressionOperand<R>::type rhs_;
+};
+
+template <typename L, typename R, typename T, size_t Dim>
+class PointDifference : public PointExpression<PointDifference<L, R, T, Dim>, T, Dim> {
+public:
+  constexpr PointDifference(const L& lhs, const R& rhs): lhs_(lhs), rhs_(rhs) {}
+
+  constexpr T operator[](size_t index) const { return lhs_[index] - rhs_[index]; }
+
+  auto lanes() const { return SimdLanes<T, Dim>::sub(lhs_.lanes(), rhs_.lanes()); }
+
+private:
+  typename ExpressionOperand<L>::type lhs_;
+  typename ExpressionOperand<R>::type rhs_;
+};
+
+template <typename E, typename T, size_t Dim>
+class PointScaled : public PointExpression<PointScaled<E, T, Dim>, T, Dim> {
+public:
+  constexpr PointScaled(const E& expression, T factor): expression_(expression), factor_(factor) {}
+
+  constexpr T operator[](size_t index) const { return expression_[index] * factor_; }
+
+  auto lanes() const { return SimdLanes<T, Dim>::mul(expression_.lanes(), SimdLanes<T, Dim>::splat(factor_)); }
+
+private:
+  typename ExpressionOperand<E>::type expression_;
+  T factor_;
 };
 
 // --- Operator Overloads for Point ---
 
 // Equality comparison (==)
-template <typename T, size_t Dim>
-bool operator==(const Point<T, Dim>& lhs, const Point<T, Dim>& rhs) {
-    // std::array already has a component-wise operator==
-    return lhs.coordinates_ == rhs.coordinates_;
+template <typename L, typename R, typename T, size_t Dim>
+constexpr bool operator==(const PointExpression<L, T, Dim>& lhs, const PointExpression<R, T, Dim>& rhs) {
+    for (size_t i = 0; i < Dim; ++i) {
+        if (!(lhs[i] == rhs[i])) return false;
+    }
+    return true;
 }
 
 // Inequality comparison (!=)
-template <typename T, size_t Dim>
-bool operator!=(const Point<T, Dim>& lhs, const Point<T, Dim>& rhs) {
+template <typename L, typename R, typename T, size_t Dim>
+constexpr bool operator!=(const PointExpression<L, T, Dim>& lhs, const PointExpression<R, T, Dim>& rhs) {
     return !(lhs == rhs);
 }
 
-// Point addition (+)
-template <typename T, size_t Dim>
-Point<T, Dim> operator+(const Point<T, Dim>& lhs, const Point<T, Dim>& rhs) {
-    Point<T, Dim> result;
-    for (size_t i = 0; i < Dim; ++i) {
-        result[i] = lhs[i] + rhs[i];
-    }
-    return result;
+// Point addition (+), evaluated lazily
+template <typename L, typename R, typename T, size_t Dim>
+constexpr PointSum<L, R, T, Dim> operator+(const PointExpression<L, T, Dim>& lhs,
+                                           const PointExpression<R, T, Dim>& rhs) {
+    return PointSum<L, R, T, Dim>(lhs.self(), rhs.self());
 }
 
-// Point subtraction (-)
-template <typename T, size_t Dim>
-Point<T, Dim> operator-(const Point<T, Dim>& lhs, const Point<T, Dim>& rhs) {
-    Point<T, Dim> result;
-    for (size_t i = 0; i < Dim; ++i) {
-        result[i] = lhs[i] - rhs[i];
-    }
-    return result;
+// Point subtraction (-), evaluated lazily
+template <typename L, typename R, typename T, size_t Dim>
+constexpr PointDifference<L, R, T, Dim> operator-(const PointExpression<L, T, Dim>& lhs,
+                                                  const PointExpression<R, T, Dim>& rhs) {
+    return PointDifference<L, R, T, Dim>(lhs.self(), rhs.self());
+}
+
+// Scalar multiplication (*), evaluated lazily
+template <typename E, typename T, size_t Dim, typename S,
+          typename = std::enable_if_t<std::is_arithmetic_v<S>>>
+constexpr PointScaled<E, T, Dim> operator*(const PointExpression<E, T, Dim>& expression, S factor) {
+    return PointScaled<E, T, Dim>(expression.self(), static_cast<T>(factor));
+}
+
+template <typename E, typename T, size_t Dim, typename S,
+          typename = std::enable_if_t<std::is_arithmetic_v<S>>>
+constexpr PointScaled<E, T, Dim> operator*(S factor, const PointExpression<E, T, Dim>& expression) {
+    return PointScaled<E, T, Dim>(expression.self(), static_cast<T>(factor));
 }
 
 // Overload the << operator for easy printing (e.g., to std::cout)
-template <typename T, size_t Dim>
-std::ostream& operator<<(std::ostream& os, const Point<T, Dim>& p) {
+template <typename E, typename T, size_t Dim>
+std::ostream& operator<<(std::ostream& os, const PointExpression<E, T, Dim>& p) {
     os << "(";
     for (size_t i = 0; i < Dim; ++i) {
         os << p[i] << (i == Dim - 1 ? "" : ", ");
@@ -79,4 +254,104 @@ std::ostream& operator<<(std::ostream& os, const Point<T, Dim>& p) {
     return os;
 }
 
+// --- Vector operations on Point ---
+
+/**
+ * @brief Calculates the dot product of two vectors.
+ * @param a First vector
+ * @param b Second vector
+ * @return The dot product
+ */
+template <typename L, typename R, typename T, size_t Dim>
+constexpr T dot_product(const PointExpression<L, T, Dim>& a, const PointExpression<R, T, Dim>& b) {
+    if constexpr (SimdLanes<T, Dim>::kEnabled) {
+        if (!__builtin_is_constant_evaluated()) {
+            using Lanes = SimdLanes<T, Dim>;
+            return Lanes::sum(Lanes::mul(a.self().lanes(), b.self().lanes()));
+        }
+    }
+    T sum{};
+    for (size_t i = 0; i < Dim; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief Calculates the cross product of two 3D vectors.
+ * @param a First vector
+ * @param b Second vector
+ * @return The cross product vector
+ */
+template <typename L, typename R, typename T>
+constexpr Point<T, 3> cross_product(const PointExpression<L, T, 3>& a, const PointExpression<R, T, 3>& b) {
+    if constexpr (SimdLanes<T, 3>::kHasCross) {
+        if (!__builtin_is_constant_evaluated()) {
+            // a x b = rotate(a * rotate(b) - rotate(a) * b); the padding lane
+            // stays a[3] * b[3] - a[3] * b[3] = 0.
+            using Lanes = SimdLanes<T, 3>;
+            const auto va = a.self().lanes();
+            const auto vb = b.self().lanes();
+            Point<T, 3> result;
+            Lanes::store(result.data(),
+                         Lanes::rotate(Lanes::sub(Lanes::mul(va, Lanes::rotate(vb)), Lanes::mul(Lanes::rotate(va), vb))));
+            return result;
+        }
+    }
+    return Point<T, 3>(
+        a[1] * b[2] - a[2] * b[1],
+        a[2] * b[0] - a[0] * b[2],
+        a[0] * b[1] - a[1] * b[0]
+    );
+}
+
+/**
+ * @brief Calculates the squared Euclidean length of a vector.
+ * squared_norm<double>(v) converts every coordinate to double before
+ * squaring and summing, which keeps float precision and avoids integer
+ * overflow.
+ * @tparam Acc Type to accumulate in; T by default
+ * @param v The vector
+ * @return The squared length
+ */
+template <typename Acc = void, typename E, typename T, size_t Dim>
+constexpr std::conditional_t<std::is_void_v<Acc>, T, Acc> squared_norm(const PointExpression<E, T, Dim>& v) {
+    using Result = std::conditional_t<std::is_void_v<Acc>, T, Acc>;
+    if constexpr (std::is_same_v<Result, T>) {
+        return dot_product(v.self(), v.self());
+    } else {
+        Result sum{};
+        for (size_t i = 0; i < Dim; ++i) {
+            const Result coordinate = static_cast<Result>(v[i]);
+            sum += coordinate * coordinate;
+        }
+        return sum;
+    }
+}
+
+/**
+ * @brief Calculates the Euclidean length of a vector.
+ * Not constexpr since std::sqrt is not.
+ * @param v The vector
+ * @return The length (double for integral T)
+ */
+template <typename E, typename T, size_t Dim>
+auto norm(const PointExpression<E, T, Dim>& v) {
+    return std::sqrt(squared_norm(v));
+}
+
+/**
+ * @brief Multiplies every coordinate of a vector by a scalar.
+ * @param v The vector
+ * @param factor The scale factor
+ * @return The scaled vector
+ */
+template <typename E, typename T, size_t Dim, typename S,
+          typename = std::enable_if_t<std::is_arithmetic_v<S>>>
+constexpr Point<T, Dim> scale(const PointExpression<E, T, Dim>& v, S factor) {
+    return Point<T, Dim>(v.self() * factor);
+}
+
 } // namespace geometry
+
+#include "common/simd_point.hh"
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <type_traits>
+#include "point.hh"
+#include "line_segment.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Geometry on compile-time-known inputs
+    constexpr Point<double, 3> a(1, 2, 3);
+    constexpr Point<double, 3> b(4, 5, 6);
+    constexpr Point<double, 3> c(0, 1, 0);
+    constexpr Point<double, 3> fused = a - b + c * 2;
+    static_assert(fused == Point<double, 3>(-3, -1, -3), "a - b + c * 2 evaluates at compile time");
+    static_assert(dot_product(a, b) == 32, "dot_product evaluates at compile time");
+    static_assert(cross_product(a, b) == Point<double, 3>(-3, 6, -3), "cross_product evaluates at compile time");
+    static_assert(squared_norm(a - b) == 27, "squared_norm evaluates at compile time");
+    static_assert(LineSegment<double, 3>(a, b).midpoint() == Point<double, 3>(2.5, 3.5, 4.5),
+                  "midpoint evaluates at compile time");
+    static_assert(!std::is_same_v<decltype(a - b + c * 2), Point<double, 3>>,
+                  "a - b + c * 2 stays a lazy expression in every layout");
+
+    std::cout << "Test 1 - Compile-time evaluation:" << std::endl;
+    std::cout << "a - b + c * 2 = " << fused << std::endl;
+    std::cout << "a . b = " << dot_product(a, b) << std::endl;
+    std::cout << "a x b = " << cross_product(a, b) << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: Runtime expressions and vector operations
+    Point<double, 2> p(3, 4);
+    Point<double, 2> q(1, 1);
+    std::cout << "Test 2 - Runtime expressions:" << std::endl;
+    std::cout << "p = " << p << ", q = " << q << std::endl;
+    std::cout << "p + q = " << p + q << std::endl;
+    std::cout << "|p| = " << norm(p) << std::endl;
+    std::cout << "scale(p, 0.5) = " << scale(p, 0.5) << std::endl;
+    p = q - p;
+    std::cout << "p = q - p -> " << p << std::endl;
+    p += q * 3;
+    std::cout << "p += q * 3 -> " << p << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: Float and padded double layouts
+    Point<float, 4> f1(1, 2, 3, 4);
+    Point<float, 4> f2(0.5, 0.5, 0.5, 0.5);
+    Point<double, 3> d1(1, 0, 0);
+    Point<double, 3> d2(0, 1, 0);
+    std::cout << "Test 3 - Float and padded double layouts:" << std::endl;
+    std::cout << "sizeof(Point<float, 4>) = " << sizeof(Point<float, 4>)
+              << ", alignof = " << alignof(Point<float, 4>) << std::endl;
+    std::cout << "sizeof(Point<double, 3>) = " << sizeof(Point<double, 3>)
+              << ", alignof = " << alignof(Point<double, 3>) << std::endl;
+    std::cout << "f1 - f2 * 2 = " << f1 - f2 * 2 << std::endl;
+    std::cout << "f1 . f2 = " << dot_product(f1, f2) << std::endl;
+    std::cout << "d1 x d2 = " << cross_product(d1, d2) << std::endl;
+    std::cout << "|d1 + d2| = " << norm(d1 + d2) << std::endl;
+    std::cout << std::endl;
+
+    // Test case 4: Lengths accumulate in double
+    LineSegment<float, 2> wide(Point<float, 2>(0, 0), Point<float, 2>(3e20f, 4e20f));
+    LineSegment<int, 2> long_int(Point<int, 2>(0, 0), Point<int, 2>(60000, 80000));
+    std::cout << "Test 4 - Lengths in double:" << std::endl;
+    std::cout << "Float length = " << wide.length() << std::endl;
+    std::cout << "Int length = " << long_int.length() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,391 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "common/bounding_box.hh"
+#include "common/line_segment.hh"
+#include "common/parallel_runs.hh"
+#include "common/point.hh"
+
+namespace geometry {
+
+/**
+ * @brief Slab decomposition of a set of labelled 2D edges for point location
+ * by the even-odd rule.
+ *
+ * The distinct y coordinates of the edge endpoints cut the plane into
+ * horizontal slabs. A segment tree over the slabs stores each edge in the
+ * O(log S) nodes whose slab ranges its y range covers, so storage is
+ * O(E log E) however many slabs an edge spans. Edges meet only at
+ * endpoints, so the edges of a node never cross inside its range and are
+ * kept in left-to-right order.
+ *
+ * The points just right of an edge can be joined along it without crossing
+ * another edge, so they lie in the same polygons everywhere; the lowest of
+ * their labels is precomputed per edge. A query finds the slab, then the
+ * nearest edge at or left of the point in each node on the path to that
+ * slab's leaf by binary search, O(log^2 E) in all, and returns the label
+ * right of the nearest of them.
+ *
+ * As in the crossing-number test, an edge covers the half-open range
+ * [y_min, y_max), and the x of an edge at the query height is evaluated with
+ * that test's expression, so each edge is on the same side of a point as
+ * there. The only difference is within rounding of a vertex, where two edges
+ * can evaluate out of their order; there the result agrees with the
+ * crossing-number test up to rounding.
+ */
+template <typename T>
+class EdgeSlabs {
+public:
+    static constexpr int32_t kNotFound = -1;
+
+    EdgeSlabs() = default;
+
+    /**
+     * @param edges The edges, which may only meet at their endpoints
+     * @param labels The label of each edge's polygon
+     */
+    EdgeSlabs(const std::vector<LineSegment<T, 2>>& edges, const std::vector<int32_t>& labels) {
+        for (const LineSegment<T, 2>& edge : edges) {
+            ys_.push_back(edge.start().y());
+            ys_.push_back(edge.end().y());
+        }
+        std::sort(ys_.begin(), ys_.end());
+        ys_.erase(std::unique(ys_.begin(), ys_.end()), ys_.end());
+        if (ys_.size() < 2) return;
+        const size_t num_slabs = ys_.size() - 1;
+
+        start_x_.resize(edges.size());
+        start_y_.resize(edges.size());
+        extent_x_.resize(edges.size());
+        extent_y_.resize(edges.size());
+        for (size_t e = 0; e < edges.size(); ++e) {
+            const Point<T, 2>& a = edges[e].start();
+            const Point<T, 2>& b = edges[e].end();
+            start_x_[e] = a.x();
+            start_y_[e] = a.y();
+            extent_x_[e] = b.x() - a.x();
+            extent_y_[e] = b.y() - a.y();
+        }
+
+        // Slabs [low, high) covered by each edge; horizontal edges cover none.
+        auto slab_of = [&](T y) { return static_cast<size_t>(std::lower_bound(ys_.begin(), ys_.end(), y) - ys_.begin()); };
+        std::vector<std::pair<uint32_t, uint32_t>> span(edges.size());
+        for (size_t e = 0; e < edges.size(); ++e) {
+            span[e].first = static_cast<uint32_t>(slab_of(std::min(edges[e].start().y(), edges[e].end().y())));
+            span[e].second = static_cast<uint32_t>(slab_of(std::max(edges[e].start().y(), edges[e].end().y())));
+        }
+
+        // Node lists in compressed form: count, prefix sum, fill.
+        offsets_.assign(4 * num_slabs + 1, 0);
+        for (const auto& [low, high] : span) {
+            cover(1, 0, num_slabs, low, high, [&](size_t node) { ++offsets_[node + 1]; });
+        }
+        for (size_t node = 0; node + 1 < offsets_.size(); ++node) {
+            offsets_[node + 1] += offsets_[node];
+        }
+        std::vector<uint32_t> cursor(offsets_.begin(), offsets_.end() - 1);
+        entries_.resize(offsets_.back());
+        for (size_t e = 0; e < edges.size(); ++e) {
+            cover(1, 0, num_slabs, span[e].first, span[e].second,
+                  [&](size_t node) { entries_[cursor[node]++] = static_cast<uint32_t>(e); });
+        }
+        sort_nodes(1, 0, num_slabs);
+
+        // The labels right of an edge are those left of it with its own
+        // toggled, and left of it are those right of its nearest neighbour
+        // on the left. Resolve neighbours first; they never form a cycle.
+        std::vector<int32_t> left_of(edges.size(), -1);
+        for (size_t e = 0; e < edges.size(); ++e) {
+            if (span[e].first == span[e].second) continue;
+            const size_t s = span[e].first;
+            const T middle = (ys_[s] + ys_[s + 1]) / 2;
+            left_of[e] = nearest_left(s, middle, x_at(static_cast<uint32_t>(e), middle), static_cast<uint32_t>(e));
+        }
+        std::vector<std::vector<int32_t>> odd(edges.size());
+        std::vector<uint8_t> resolved(edges.size(), 0);
+        std::vector<uint32_t> pending;
+        right_labels_.assign(edges.size(), kNotFound);
+        for (size_t first = 0; first < edges.size(); ++first) {
+            if (span[first].first == span[first].second) continue;
+            pending.push_back(static_cast<uint32_t>(first));
+            while (!pending.empty()) {
+                const uint32_t e = pending.back();
+                if (resolved[e]) {
+                    pending.pop_back();
+                    continue;
+                }
+                const int32_t neighbour = left_of[e];
+                if (neighbour >= 0 && !resolved[neighbour]) {
+                    pending.push_back(static_cast<uint32_t>(neighbour));
+                    continue;
+                }
+                pending.pop_back();
+                if (neighbour >= 0) odd[e] = odd[neighbour];
+                auto it = std::lower_bound(odd[e].begin(), odd[e].end(), labels[e]);
+                if (it != odd[e].end() && *it == labels[e]) odd[e].erase(it);
+                else odd[e].insert(it, labels[e]);
+                right_labels_[e] = odd[e].empty() ? kNotFound : odd[e].front();
+                resolved[e] = 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the lowest label of the polygons containing a point.
+     * @return The label, or kNotFound
+     */
+    int32_t locate(const Point<T, 2>& p) const {
+        if (ys_.size() < 2 || !(p.y() >= ys_.front()) || !(p.y() < ys_.back())) return kNotFound;
+        const size_t s = static_cast<size_t>(std::upper_bound(ys_.begin(), ys_.end(), p.y()) - ys_.begin()) - 1;
+        const int32_t e = nearest_left(s, p.y(), p.x(), kAnyEdge);
+        return e < 0 ? kNotFound : right_labels_[e];
+    }
+
+private:
+    static constexpr uint32_t kLinearScan = 16;
+    static constexpr uint32_t kAnyEdge = UINT32_MAX;
+
+    // Slab s is [ys_[s], ys_[s + 1]).
+    std::vector<T> ys_;
+    // Segment tree over the slabs, node 1 the root and 2n, 2n + 1 the
+    // children of n: the edges of each node in left-to-right order.
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> entries_;
+    // Per edge: its start point, end minus start, and the lowest label of
+    // the polygons just right of it.
+    std::vector<T> start_x_;
+    std::vector<T> start_y_;
+    std::vector<T> extent_x_;
+    std::vector<T> extent_y_;
+    std::vector<int32_t> right_labels_;
+
+    // x of edge e at height y, as in the crossing-number test.
+    T x_at(uint32_t e, T y) const { return start_x_[e] + (y - start_y_[e]) * extent_x_[e] / extent_y_[e]; }
+
+    // Calls fn(node) for the nodes of [l, r) that together cover [low, high).
+    template <typename Fn>
+    static void cover(size_t node, size_t l, size_t r, size_t low, size_t high, Fn&& fn) {
+        if (high <= l || r <= low) return;
+        if (low <= l && r <= high) {
+            fn(node);
+            return;
+        }
+        const size_t mid = l + (r - l) / 2;
+        cover(2 * node, l, mid, low, high, fn);
+        cover(2 * node + 1, mid, r, low, high, fn);
+    }
+
+    // Orders the edges of every node by x at the middle of its range, and
+    // edges that coincide there, such as an edge shared by two polygons, by
+    // index.
+    void sort_nodes(size_t node, size_t l, size_t r) {
+        const T middle = (ys_[l] + ys_[r]) / 2;
+        std::sort(entries_.begin() + offsets_[node], entries_.begin() + offsets_[node + 1],
+                  [&](uint32_t e1, uint32_t e2) {
+                      const T x1 = x_at(e1, middle), x2 = x_at(e2, middle);
+                      return x1 < x2 || (x1 == x2 && e1 < e2);
+                  });
+        if (r - l == 1) return;
+        const size_t mid = l + (r - l) / 2;
+        sort_nodes(2 * node, l, mid);
+        sort_nodes(2 * node + 1, mid, r);
+    }
+
+    /**
+     * @brief Finds the rightmost edge crossing height y in slab s whose x
+     * there is below x, or equal to x with an index below limit. Ties go to
+     * the edge further right at the middle of the slab, then to the higher
+     * index, as in the order of the nodes.
+     * @return The edge, or -1
+     */
+    int32_t nearest_left(size_t s, T y, T x, uint32_t limit) const {
+        auto before = [&](uint32_t e) {
+            const T xe = x_at(e, y);
+            return xe < x || (xe == x && e < limit);
+        };
+        int32_t best = -1;
+        T best_x = 0;
+        size_t node = 1, l = 0, r = ys_.size() - 1;
+        while (true) {
+            const uint32_t begin = offsets_[node];
+            const uint32_t end = offsets_[node + 1];
+            // Edges at or left of x. Short lists are counted without
+            // branches, which the compiler vectorizes.
+            uint32_t left;
+            if (end - begin <= kLinearScan) {
+                left = 0;
+                for (uint32_t i = begin; i < end; ++i) {
+                    left += before(entries_[i]);
+                }
+            } else {
+                uint32_t low = begin, high = end;
+                while (low < high) {
+                    uint32_t mid = low + (high - low) / 2;
+                    if (before(entries_[mid])) low = mid + 1;
+                    else high = mid;
+                }
+                left = low - begin;
+            }
+            if (left > 0) {
+                const uint32_t e = entries_[begin + left - 1];
+                const T xe = x_at(e, y);
+                if (best < 0 || xe > best_x) {
+                    best = static_cast<int32_t>(e);
+                    best_x = xe;
+                } else if (xe == best_x) {
+                    const T middle = (ys_[s] + ys_[s + 1]) / 2;
+                    const T xm = x_at(e, middle), best_xm = x_at(static_cast<uint32_t>(best), middle);
+                    if (xm > best_xm || (xm == best_xm && e > static_cast<uint32_t>(best))) {
+                        best = static_cast<int32_t>(e);
+                    }
+                }
+            }
+            if (r - l == 1) break;
+            const size_t mid = l + (r - l) / 2;
+            if (s < mid) {
+                node = 2 * node;
+                r = mid;
+            } else {
+                node = 2 * node + 1;
+                l = mid;
+            }
+        }
+        return best;
+    }
+};
+
+/**
+ * @brief A polygon, possibly with holes, given by its boundary edges, with a
+ * precomputed slab decomposition for O(log E) point-in-polygon tests.
+ */
+template <typename T>
+class Polygon {
+public:
+    /**
+     * @brief Builds a polygon from a closed ring of vertices.
+     * @throws std::invalid_argument if there are fewer than 3 vertices
+     */
+    explicit Polygon(const std::vector<Point<T, 2>>& ring) {
+        if (ring.size() < 3) {
+            throw std::invalid_argument("A polygon needs at least 3 vertices");
+        }
+        for (size_t i = 0; i < ring.size(); ++i) {
+            edges_.emplace_back(ring[i], ring[(i + 1) % ring.size()]);
+        }
+        build();
+    }
+
+    /**
+     * @brief Builds a polygon from boundary edges, e.g. several rings for a
+     * polygon with holes. Inside is decided by the even-odd rule.
+     * @param edges The edges, which may only meet at their endpoints
+     */
+    explicit Polygon(const std::vector<LineSegment<T, 2>>& edges): edges_(edges) {
+        build();
+    }
+
+    const std::vector<LineSegment<T, 2>>& edges() const { return edges_; }
+
+    const BoundingBox<T, 2>& bounds() const { return bounds_; }
+
+    /**
+     * @brief Checks if a point is inside the polygon.
+     */
+    bool contains(const Point<T, 2>& p) const {
+        return bounds_.contains(p) && slabs_.locate(p) != EdgeSlabs<T>::kNotFound;
+    }
+
+    /**
+     * @brief Classifies many points; each thread handles a contiguous run.
+     * @param points The points
+     * @param executor Pool and number of threads
+     * @return For each point, 1 if it is inside and 0 otherwise
+     */
+    std::vector<uint8_t> contains(const std::vector<Point<T, 2>>& points,
+                                  Executor executor = Executor()) const {
+        std::vector<uint8_t> result(points.size());
+        for_each_run(points.size(), executor, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                result[i] = contains(points[i]) ? 1 : 0;
+            }
+        });
+        return result;
+    }
+
+private:
+    std::vector<LineSegment<T, 2>> edges_;
+    BoundingBox<T, 2> bounds_;
+    EdgeSlabs<T> slabs_;
+
+    void build() {
+        for (const LineSegment<T, 2>& edge : edges_) {
+            bounds_.expand(edge.start());
+            bounds_.expand(edge.end());
+        }
+        slabs_ = EdgeSlabs<T>(edges_, std::vector<int32_t>(edges_.size(), 0));
+    }
+};
+
+/**
+ * @brief A fixed set of polygons, indexed together so that finding the
+ * polygon containing a point costs O(log E) in the total edge count.
+ */
+template <typename T>
+class PolygonSet {
+public:
+    static constexpr int32_t kNotFound = EdgeSlabs<T>::kNotFound;
+
+    /**
+     * @param polygons The polygons; a polygon's id is its index. Edges of
+     *                 different polygons may only meet at their endpoints.
+     */
+    explicit PolygonSet(const std::vector<Polygon<T>>& polygons) {
+        std::vector<LineSegment<T, 2>> edges;
+        std::vector<int32_t> labels;
+        for (size_t id = 0; id < polygons.size(); ++id) {
+            for (const LineSegment<T, 2>& edge : polygons[id].edges()) {
+                edges.push_back(edge);
+                labels.push_back(static_cast<int32_t>(id));
+            }
+            bounds_.expand(polygons[id].bounds());
+        }
+        slabs_ = EdgeSlabs<T>(edges, labels);
+    }
+
+    /**
+     * @brief Finds the polygon containing a point.
+     * @return Its id (the lowest id if polygons overlap), or kNotFound
+     */
+    int32_t locate(const Point<T, 2>& p) const {
+        return bounds_.contains(p) ? slabs_.locate(p) : kNotFound;
+    }
+
+    /**
+     * @brief Locates many points; each thread handles a contiguous run.
+     * @param points The points
+     * @param executor Pool and number of threads
+     * @return For each point, the id of the containing polygon or kNotFound
+     */
+    std::vector<int32_t> locate(const std::vector<Point<T, 2>>& points,
+                                Executor executor = Executor()) const {
+        std::vector<int32_t> result(points.size());
+        for_each_run(points.size(), executor, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                result[i] = locate(points[i]);
+            }
+        });
+        return result;
+    }
+
+private:
+    BoundingBox<T, 2> bounds_;
+    EdgeSlabs<T> slabs_;
+};
+
+} // namespace geometry
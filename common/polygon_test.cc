@@ -0,0 +1,157 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sys/resource.h>
+#include "polygon.hh"
+
+namespace {
+
+// Peak resident set size of the process so far, in MB.
+double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+// Crossing-number test over every edge, for reference.
+template <typename T>
+bool crossing_number_contains(const std::vector<geometry::LineSegment<T, 2>>& edges, const geometry::Point<T, 2>& p) {
+    bool inside = false;
+    for (const auto& edge : edges) {
+        const auto& a = edge.start();
+        const auto& b = edge.end();
+        if ((a.y() <= p.y()) != (b.y() <= p.y())) {
+            T x = a.x() + (p.y() - a.y()) * (b.x() - a.x()) / (b.y() - a.y());
+            if (p.x() < x) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+}  // namespace
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: A square with a square hole
+    std::vector<LineSegment<double, 2>> edges;
+    auto add_ring = [&](const std::vector<Point<double, 2>>& ring) {
+        for (size_t i = 0; i < ring.size(); ++i) {
+            edges.emplace_back(ring[i], ring[(i + 1) % ring.size()]);
+        }
+    };
+    add_ring({Point<double, 2>(0, 0), Point<double, 2>(4, 0), Point<double, 2>(4, 4), Point<double, 2>(0, 4)});
+    add_ring({Point<double, 2>(1, 1), Point<double, 2>(1, 3), Point<double, 2>(3, 3), Point<double, 2>(3, 1)});
+    Polygon<double> frame(edges);
+    std::cout << "Test 1 - Square with a hole:" << std::endl;
+    std::cout << "(0.5, 2) inside? " << (frame.contains(Point<double, 2>(0.5, 2)) ? "Yes" : "No") << std::endl;
+    std::cout << "(2, 2) inside? " << (frame.contains(Point<double, 2>(2, 2)) ? "Yes" : "No") << std::endl;
+    std::cout << "(5, 2) inside? " << (frame.contains(Point<double, 2>(5, 2)) ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: A random star-shaped polygon against the crossing-number test
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<double> radius(0.3, 1.0);
+    std::vector<Point<double, 2>> ring;
+    const double pi = std::acos(-1.0);
+    for (int i = 0; i < 5000; ++i) {
+        double angle = 2 * pi * i / 5000;
+        double r = radius(rng);
+        ring.emplace_back(r * std::cos(angle), r * std::sin(angle));
+    }
+    Polygon<double> star(ring);
+    std::uniform_real_distribution<double> coordinate(-1.1, 1.1);
+    std::vector<Point<double, 2>> points(50000);
+    for (Point<double, 2>& p : points) {
+        p = Point<double, 2>(coordinate(rng), coordinate(rng));
+    }
+    std::vector<uint8_t> inside = star.contains(points, 4);
+    size_t num_inside = 0, mismatches = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        num_inside += inside[i];
+        mismatches += inside[i] != crossing_number_contains(star.edges(), points[i]);
+    }
+    std::cout << "Test 2 - Star polygon with " << star.edges().size() << " edges:" << std::endl;
+    std::cout << "Points inside: " << num_inside << " of " << points.size() << std::endl;
+    std::cout << "Matches crossing-number test? " << (mismatches == 0 ? "Yes" : "No") << std::endl;
+
+    // Points placed on the edges, at the x the crossing-number test computes
+    std::uniform_real_distribution<double> fraction(0.05, 0.95);
+    size_t edge_mismatches = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const auto& edge = star.edges()[i % star.edges().size()];
+        const auto& a = edge.start();
+        const auto& b = edge.end();
+        if (a.y() == b.y()) continue;
+        const double y = a.y() + fraction(rng) * (b.y() - a.y());
+        const Point<double, 2> p(a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y()), y);
+        edge_mismatches += star.contains(p) != crossing_number_contains(star.edges(), p);
+    }
+    std::cout << "Points on edges match crossing-number test? " << (edge_mismatches == 0 ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: A grid of triangles sharing vertices
+    std::vector<Polygon<double>> cells;
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 10; ++x) {
+            cells.emplace_back(std::vector<Point<double, 2>>{Point<double, 2>(x, y), Point<double, 2>(x + 1, y), Point<double, 2>(x + 1, y + 1)});
+            cells.emplace_back(std::vector<Point<double, 2>>{Point<double, 2>(x, y), Point<double, 2>(x + 1, y + 1), Point<double, 2>(x, y + 1)});
+        }
+    }
+    PolygonSet<double> grid(cells);
+    std::uniform_real_distribution<double> grid_coordinate(-1, 11);
+    for (Point<double, 2>& p : points) {
+        p = Point<double, 2>(grid_coordinate(rng), grid_coordinate(rng));
+    }
+    std::vector<int32_t> ids = grid.locate(points, 4);
+    size_t id_mismatches = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        int32_t expected = PolygonSet<double>::kNotFound;
+        for (size_t c = 0; c < cells.size() && expected < 0; ++c) {
+            if (crossing_number_contains(cells[c].edges(), points[i])) expected = static_cast<int32_t>(c);
+        }
+        id_mismatches += ids[i] != expected;
+    }
+    std::cout << "Test 3 - Set of " << cells.size() << " triangles:" << std::endl;
+    std::cout << "(2.7, 5.2) is in polygon " << grid.locate(Point<double, 2>(2.7, 5.2)) << std::endl;
+    std::cout << "(12, 5) is in polygon " << grid.locate(Point<double, 2>(12, 5)) << std::endl;
+    std::cout << "Matches crossing-number test? " << (id_mismatches == 0 ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 4: Many polygons side by side in one latitude band, so that
+    // every slab is crossed by edges of all of them
+    const size_t num_cells = 300, num_vertices = 1000;
+    std::vector<Polygon<double>> band;
+    std::uniform_real_distribution<double> band_radius(0.2, 0.45);
+    for (size_t c = 0; c < num_cells; ++c) {
+        std::vector<Point<double, 2>> cell_ring;
+        for (size_t i = 0; i < num_vertices; ++i) {
+            double angle = 2 * pi * i / num_vertices;
+            double r = band_radius(rng);
+            cell_ring.emplace_back(c + 0.5 + r * std::cos(angle), 0.5 + r * std::sin(angle));
+        }
+        band.emplace_back(cell_ring);
+    }
+    const double rss_before = peak_rss_mb();
+    auto start = std::chrono::steady_clock::now();
+    PolygonSet<double> band_set(band);
+    const double build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double build_mb = peak_rss_mb() - rss_before;
+    std::uniform_real_distribution<double> band_x(0, static_cast<double>(num_cells));
+    std::uniform_real_distribution<double> band_y(0, 1);
+    size_t band_mismatches = 0;
+    for (int i = 0; i < 20000; ++i) {
+        Point<double, 2> p(band_x(rng), band_y(rng));
+        const size_t c = std::min(num_cells - 1, static_cast<size_t>(p.x()));
+        int32_t expected = crossing_number_contains(band[c].edges(), p) ? static_cast<int32_t>(c) : -1;
+        band_mismatches += band_set.locate(p) != expected;
+    }
+    std::cout << "Test 4 - Band of " << num_cells << " polygons with " << num_cells * num_vertices << " edges:" << std::endl;
+    std::cout << "Built in " << build_seconds << " s, peak memory grew by " << build_mb << " MB" << std::endl;
+    std::cout << "Build memory under 1 KB per edge? "
+              << (build_mb * 1024 < static_cast<double>(num_cells * num_vertices) ? "Yes" : "No") << std::endl;
+    std::cout << "Matches crossing-number test? " << (band_mismatches == 0 ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,288 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common/bounding_box.hh"
+#include "common/line_segment.hh"
+#include "common/line_segment_intersection.hh"
+#include "common/parallel_runs.hh"
+#include "common/point.hh"
+
+namespace geometry {
+
+/**
+ * @brief Open or closed chain of 2D line segments through a list of vertices.
+ *
+ * Self-intersections are found without testing every pair of edges. The
+ * polyline is split into strictly x-monotone chains (a vertical edge is a
+ * chain of its own) of at most kMaxChainEdges edges, which keeps their boxes
+ * tight around curved or nested parts. Edges within one chain cannot cross,
+ * and the edges of two chains can only meet where their x-ranges overlap, so
+ * a sweep over the chains' bounding boxes yields candidate chain pairs, and a
+ * merge along x of each pair yields the candidate edge pairs for the exact
+ * test. The sweep runs separately in horizontal strips about two chain
+ * heights tall, so that chains far apart in y never meet in its active list.
+ */
+template <typename T>
+class Polyline {
+public:
+    /**
+     * @brief A point where two non-adjacent edges meet, or where two adjacent
+     * edges fold back over each other.
+     */
+    struct SelfIntersection {
+        uint32_t edge1;
+        uint32_t edge2;
+        Point<T, 2> point;
+    };
+
+    /**
+     * @param vertices The vertices in order
+     * @param closed Whether an edge joins the last vertex back to the first
+     */
+    explicit Polyline(std::vector<Point<T, 2>> vertices, bool closed = false)
+        : vertices_(std::move(vertices)), closed_(closed) {
+        build_chains();
+    }
+
+    const std::vector<Point<T, 2>>& vertices() const { return vertices_; }
+
+    bool closed() const { return closed_; }
+
+    size_t num_edges() const {
+        if (vertices_.size() < 2) return 0;
+        return closed_ ? vertices_.size() : vertices_.size() - 1;
+    }
+
+    LineSegment<T, 2> edge(size_t i) const {
+        return LineSegment<T, 2>(vertices_[i], vertices_[(i + 1) % vertices_.size()]);
+    }
+
+    size_t num_chains() const { return chains_.size(); }
+
+    /**
+     * @brief Finds all self-intersections.
+     * @param executor Pool and number of threads
+     * @return The intersections, sorted by (edge1, edge2), with edge1 < edge2
+     */
+    std::vector<SelfIntersection> self_intersections(Executor executor = Executor()) const {
+        return find(executor, false);
+    }
+
+    /**
+     * @brief Checks that no two edges intersect except adjacent edges at
+     * their shared vertex. Stops at the first intersection found.
+     */
+    bool is_simple(Executor executor = Executor()) const {
+        return find(executor, true).empty();
+    }
+
+private:
+    static constexpr size_t kMaxChainEdges = 8;
+
+    // Edges first, ..., last - 1 (modulo the edge count); increasing is
+    // false when x decreases along them.
+    struct Chain {
+        uint32_t first;
+        uint32_t last;
+        bool increasing;
+        BoundingBox<T, 2> bounds;
+    };
+
+    std::vector<Point<T, 2>> vertices_;
+    bool closed_;
+    std::vector<Chain> chains_;
+
+    void build_chains() {
+        const size_t n = num_edges();
+        auto direction = [&](size_t i) {
+            T dx = vertices_[(i + 1) % vertices_.size()].x() - vertices_[i].x();
+            return dx > 0 ? 1 : (dx < 0 ? -1 : 0);
+        };
+        for (size_t i = 0; i < n;) {
+            int d = direction(i);
+            size_t end = i + 1;
+            while (d != 0 && end < n && end - i < kMaxChainEdges && direction(end) == d) {
+                ++end;
+            }
+            Chain chain{static_cast<uint32_t>(i), static_cast<uint32_t>(end), d >= 0, BoundingBox<T, 2>()};
+            for (size_t e = i; e < end; ++e) {
+                chain.bounds.expand(vertices_[e]);
+            }
+            chain.bounds.expand(vertices_[end % vertices_.size()]);
+            chains_.push_back(chain);
+            i = end;
+        }
+    }
+
+    bool adjacent(size_t e1, size_t e2) const {
+        const size_t n = num_edges();
+        return e2 == e1 + 1 || e1 == e2 + 1 || (closed_ && n > 2 && ((e1 == 0 && e2 == n - 1) || (e2 == 0 && e1 == n - 1)));
+    }
+
+    // Tests one candidate pair; adjacent edges count only if they fold back
+    // over each other past their shared vertex.
+    bool test(uint32_t e1, uint32_t e2, std::vector<SelfIntersection>& found) const {
+        if (e1 == e2) return false;
+        if (e1 > e2) std::swap(e1, e2);
+        LineSegment<T, 2> s1 = edge(e1);
+        LineSegment<T, 2> s2 = edge(e2);
+        if (adjacent(e1, e2)) {
+            // Order the edges so that a -> b -> c.
+            bool forward = e2 == e1 + 1;
+            const LineSegment<T, 2>& in = forward ? s1 : s2;
+            const LineSegment<T, 2>& out = forward ? s2 : s1;
+            const Point<T, 2>& a = in.start();
+            const Point<T, 2>& b = in.end();
+            const Point<T, 2>& c = out.end();
+            if (orientation(a, b, c) != 0 || dot_product(b - a, c - b) >= 0) return false;
+            found.push_back(SelfIntersection{e1, e2, squared_norm(c - b) < squared_norm(a - b) ? c : a});
+            return true;
+        }
+        if (!do_intersect(s1, s2)) return false;
+
+        Point<T, 2> point = intersection_point(s1, s2);
+        // Parallel edges overlap along a segment; report an endpoint inside it.
+        if (orientation(s1.start(), s1.end(), s2.start()) == 0 && orientation(s1.start(), s1.end(), s2.end()) == 0) {
+            if (on_segment(s1.start(), s2.start(), s1.end())) point = s2.start();
+            else if (on_segment(s1.start(), s2.end(), s1.end())) point = s2.end();
+            else point = s1.start();
+        }
+        found.push_back(SelfIntersection{e1, e2, point});
+        return true;
+    }
+
+    // Edge k of a chain in order of increasing x.
+    uint32_t chain_edge(const Chain& chain, uint32_t k) const {
+        return chain.increasing ? chain.first + k : chain.last - 1 - k;
+    }
+
+    T edge_min_x(uint32_t e) const {
+        return std::min(vertices_[e].x(), vertices_[(e + 1) % vertices_.size()].x());
+    }
+
+    T edge_max_x(uint32_t e) const {
+        return std::max(vertices_[e].x(), vertices_[(e + 1) % vertices_.size()].x());
+    }
+
+    /**
+     * @brief Tests the edge pairs of two chains whose x-ranges overlap. Both
+     * chains' edges are visited in increasing x, and for each edge of a the
+     * window of b's edges overlapping it in x only moves right.
+     */
+    bool test_chains(const Chain& a, const Chain& b, bool first_only, std::vector<SelfIntersection>& found) const {
+        const uint32_t size_a = a.last - a.first;
+        const uint32_t size_b = b.last - b.first;
+        bool any = false;
+        uint32_t window = 0;
+        for (uint32_t i = 0; i < size_a; ++i) {
+            uint32_t ea = chain_edge(a, i);
+            T low = edge_min_x(ea);
+            T high = edge_max_x(ea);
+            while (window < size_b && edge_max_x(chain_edge(b, window)) < low) {
+                ++window;
+            }
+            for (uint32_t j = window; j < size_b; ++j) {
+                uint32_t eb = chain_edge(b, j);
+                if (edge_min_x(eb) > high) break;
+                if (test(ea, eb, found)) {
+                    any = true;
+                    if (first_only) return true;
+                }
+            }
+        }
+        return any;
+    }
+
+    std::vector<SelfIntersection> find(const Executor& executor, bool first_only) const {
+        std::vector<std::vector<SelfIntersection>> found(executor.num_threads());
+        if (chains_.empty()) return {};
+
+        // Strips of about twice the mean chain height, in compressed form.
+        BoundingBox<T, 2> all;
+        T total_height = 0;
+        for (const Chain& chain : chains_) {
+            all.expand(chain.bounds);
+            total_height += chain.bounds.extent(1);
+        }
+        const T low_y = all.min().y();
+        const T strip_height = 2 * total_height / chains_.size();
+        size_t num_strips = 1;
+        if (strip_height > 0) {
+            num_strips = static_cast<size_t>(std::min<T>(all.extent(1) / strip_height, chains_.size())) + 1;
+        }
+        const T per_strip = all.extent(1) > 0 ? num_strips / all.extent(1) : 0;
+        auto strip_of = [&](T y) {
+            return std::min(num_strips - 1, static_cast<size_t>(std::max<T>(0, (y - low_y) * per_strip)));
+        };
+        std::vector<uint32_t> offsets(num_strips + 1, 0);
+        for (const Chain& chain : chains_) {
+            for (size_t s = strip_of(chain.bounds.min().y()); s <= strip_of(chain.bounds.max().y()); ++s) {
+                ++offsets[s + 1];
+            }
+        }
+        for (size_t s = 0; s < num_strips; ++s) {
+            offsets[s + 1] += offsets[s];
+        }
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        std::vector<uint32_t> members(offsets.back());
+        for (uint32_t c = 0; c < chains_.size(); ++c) {
+            for (size_t s = strip_of(chains_[c].bounds.min().y()); s <= strip_of(chains_[c].bounds.max().y()); ++s) {
+                members[cursor[s]++] = c;
+            }
+        }
+
+        // Sweep each strip's chain boxes along x, in parallel. A pair whose
+        // boxes overlap is tested only in the strip where the overlap starts.
+        std::atomic<bool> stop{false};
+        std::atomic<size_t> next_run{0};
+        for_each_run(num_strips, executor, [&](size_t begin, size_t end) {
+            std::vector<SelfIntersection>& local = found[next_run.fetch_add(1)];
+            std::vector<uint32_t> active;
+            for (size_t s = begin; s < end && !stop.load(std::memory_order_relaxed); ++s) {
+                auto first = members.begin() + offsets[s];
+                auto last = members.begin() + offsets[s + 1];
+                std::sort(first, last, [&](uint32_t c1, uint32_t c2) {
+                    return chains_[c1].bounds.min().x() < chains_[c2].bounds.min().x();
+                });
+                active.clear();
+                for (auto it = first; it != last; ++it) {
+                    const Chain& chain = chains_[*it];
+                    size_t kept = 0;
+                    for (uint32_t other : active) {
+                        const BoundingBox<T, 2>& box = chains_[other].bounds;
+                        if (box.max().x() < chain.bounds.min().x()) continue;
+                        active[kept++] = other;
+                        if (!box.intersects(chain.bounds) ||
+                            strip_of(std::max(box.min().y(), chain.bounds.min().y())) != s) {
+                            continue;
+                        }
+                        if (test_chains(chains_[other], chain, first_only, local) && first_only) {
+                            stop.store(true, std::memory_order_relaxed);
+                        }
+                    }
+                    active.resize(kept);
+                    active.push_back(*it);
+                }
+            }
+        });
+
+        std::vector<SelfIntersection> result;
+        for (const auto& local : found) {
+            result.insert(result.end(), local.begin(), local.end());
+        }
+        std::sort(result.begin(), result.end(), [](const SelfIntersection& s1, const SelfIntersection& s2) {
+            return s1.edge1 < s2.edge1 || (s1.edge1 == s2.edge1 && s1.edge2 < s2.edge2);
+        });
+        if (first_only && result.size() > 1) result.resize(1);
+        return result;
+    }
+};
+
+} // namespace geometry
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "polyline.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Small polylines
+    Polyline<double> zigzag({Point<double, 2>(0, 0), Point<double, 2>(1, 1), Point<double, 2>(2, 0), Point<double, 2>(3, 1)});
+    Polyline<double> bowtie({Point<double, 2>(0, 0), Point<double, 2>(2, 2), Point<double, 2>(2, 0), Point<double, 2>(0, 2)}, true);
+    Polyline<double> backtrack({Point<double, 2>(0, 0), Point<double, 2>(2, 0), Point<double, 2>(1, 0)});
+    std::cout << "Test 1 - Small polylines:" << std::endl;
+    std::cout << "Zigzag is simple? " << (zigzag.is_simple() ? "Yes" : "No") << std::endl;
+    std::cout << "Bowtie is simple? " << (bowtie.is_simple() ? "Yes" : "No") << std::endl;
+    for (const auto& hit : bowtie.self_intersections()) {
+        std::cout << "Bowtie edges " << hit.edge1 << " and " << hit.edge2 << " cross at " << hit.point << std::endl;
+    }
+    std::cout << "Backtracking polyline is simple? " << (backtrack.is_simple() ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: A random walk against all pairs of edges
+    std::mt19937 rng(6);
+    std::normal_distribution<double> step;
+    std::vector<Point<double, 2>> walk{Point<double, 2>(0, 0)};
+    for (int i = 0; i < 2000; ++i) {
+        walk.push_back(walk.back() + Point<double, 2>(step(rng), step(rng)));
+    }
+    Polyline<double> track(walk);
+    std::vector<std::pair<uint32_t, uint32_t>> expected;
+    for (uint32_t i = 0; i < track.num_edges(); ++i) {
+        for (uint32_t j = i + 2; j < track.num_edges(); ++j) {
+            if (do_intersect(track.edge(i), track.edge(j))) expected.emplace_back(i, j);
+        }
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> found;
+    for (const auto& hit : track.self_intersections(4)) {
+        found.emplace_back(hit.edge1, hit.edge2);
+    }
+    std::cout << "Test 2 - Random walk:" << std::endl;
+    std::cout << track.num_edges() << " edges in " << track.num_chains() << " monotone chains" << std::endl;
+    std::cout << "Self-intersections: " << found.size() << std::endl;
+    std::cout << "Matches all pairs? " << (found == expected ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: A long simple spiral, sampled every 0.01 along its length
+    // with turns 0.1 apart
+    std::vector<Point<double, 2>> spiral;
+    double angle = 0;
+    for (int i = 0; i < 1000000; ++i) {
+        double radius = 1 + 0.1 * angle / (2 * M_PI);
+        spiral.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+        angle += 0.01 / radius;
+    }
+    Polyline<double> long_track(spiral);
+    auto start = std::chrono::steady_clock::now();
+    bool simple = long_track.is_simple(4);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Test 3 - Spiral with " << long_track.num_edges() << " edges:" << std::endl;
+    std::cout << "Is simple? " << (simple ? "Yes" : "No") << std::endl;
+    std::cout << "Checked in under a second? " << (seconds < 1 ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
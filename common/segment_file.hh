@@ -0,0 +1,499 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/bounding_box.hh"
+#include "common/line_segment.hh"
+#include "common/point.hh"
+
+namespace geometry {
+
+// Columnar file of line segments.
+//
+// The file starts with a SegmentFileHeader and ends with an index of one
+// ChunkHeader per chunk. In between, each chunk stores its segments column by
+// column, in the order start x, start y, [start z,] end x, end y, [end z].
+// Every column starts on a 64-byte boundary and is either raw little-endian
+// scalars or XOR-encoded (see encode_xor_column). A chunk header holds the
+// chunk's bounding box, so that a reader can skip chunks that cannot match a
+// query without touching their data.
+
+constexpr char kSegmentFileMagic[8] = {'G', 'E', 'O', 'S', 'E', 'G', '0', '1'};
+constexpr uint32_t kSegmentFileVersion = 1;
+constexpr size_t kSegmentFileAlignment = 64;
+
+enum class ColumnEncoding : uint32_t {
+    kRaw = 0,
+    kXor = 1,
+};
+
+struct SegmentFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dimension;
+    uint32_t scalar_bytes;
+    uint32_t reserved;
+    uint64_t num_segments;
+    uint64_t num_chunks;
+    // Byte offset of the chunk index.
+    uint64_t index_offset;
+    uint8_t padding[16];
+};
+static_assert(sizeof(SegmentFileHeader) == 64, "SegmentFileHeader must stay 64 bytes");
+
+struct ColumnHeader {
+    uint64_t offset;
+    uint64_t bytes;
+    ColumnEncoding encoding;
+    uint32_t reserved;
+};
+
+struct ChunkHeader {
+    uint64_t first_segment;
+    uint64_t count;
+    // Bounding box of the chunk's endpoints; unused dimensions are 0.
+    double min[3];
+    double max[3];
+    ColumnHeader columns[6];
+};
+
+/**
+ * @brief Encodes a column by XOR with the previous value's bits. Each value
+ * is a tag byte, 0x80 if it repeats the previous one and otherwise the
+ * number of leading zero bytes of the XOR times 16 plus its number of
+ * trailing zero bytes, followed by the bytes in between. Slowly varying or
+ * grid-aligned coordinates share their high or low bytes and shrink;
+ * arbitrary values grow by one byte, in which case the writer keeps them raw.
+ */
+template <typename T>
+void encode_xor_column(const T* values, size_t count, std::vector<uint8_t>& out) {
+    using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+    constexpr int kWidth = sizeof(T);
+    Bits previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Bits bits;
+        std::memcpy(&bits, &values[i], sizeof(T));
+        Bits x = bits ^ previous;
+        previous = bits;
+        if (x == 0) {
+            out.push_back(0x80);
+            continue;
+        }
+        int lead = 0, trail = 0;
+        while (((x >> (8 * (kWidth - 1 - lead))) & 0xff) == 0) {
+            ++lead;
+        }
+        while (((x >> (8 * trail)) & 0xff) == 0) {
+            ++trail;
+        }
+        out.push_back(static_cast<uint8_t>(lead << 4 | trail));
+        for (int b = trail; b < kWidth - lead; ++b) {
+            out.push_back(static_cast<uint8_t>(x >> (8 * b)));
+        }
+    }
+}
+
+/**
+ * @brief Decodes a column written by encode_xor_column.
+ * @throws std::runtime_error if the data ends early
+ */
+template <typename T>
+void decode_xor_column(const uint8_t* data, size_t bytes, size_t count, T* values) {
+    using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+    constexpr int kWidth = sizeof(T);
+    const uint8_t* end = data + bytes;
+    Bits previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (data == end) throw std::runtime_error("Truncated XOR column");
+        const uint8_t tag = *data++;
+        Bits x = 0;
+        if (tag != 0x80) {
+            const int lead = tag >> 4;
+            const int trail = tag & 15;
+            if (lead + trail >= kWidth || end - data < kWidth - lead - trail) {
+                throw std::runtime_error("Corrupt XOR column");
+            }
+            for (int b = trail; b < kWidth - lead; ++b) {
+                x |= static_cast<Bits>(*data++) << (8 * b);
+            }
+        }
+        previous ^= x;
+        std::memcpy(&values[i], &previous, sizeof(T));
+    }
+}
+
+/**
+ * @brief Reads only the header of a segment file.
+ * @throws std::runtime_error if the file cannot be read or is not a segment file
+ */
+inline SegmentFileHeader read_segment_file_header(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    SegmentFileHeader header;
+    const ssize_t got = ::pread(fd, &header, sizeof(header), 0);
+    ::close(fd);
+    if (got != static_cast<ssize_t>(sizeof(header)) ||
+        std::memcmp(header.magic, kSegmentFileMagic, sizeof(kSegmentFileMagic)) != 0) {
+        throw std::runtime_error(path + " is not a segment file");
+    }
+    if (header.version != kSegmentFileVersion) {
+        throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+    }
+    return header;
+}
+
+/**
+ * @brief Writes segments to a columnar file through a growing shared memory
+ * mapping. Segments are buffered into columns and written one chunk at a
+ * time, so memory use is bounded by the chunk size.
+ */
+template <typename T, size_t Dim>
+class SegmentFileWriter {
+    static_assert(Dim == 2 || Dim == 3, "Segment files hold 2D or 3D segments");
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value,
+                  "Segment files hold float or double coordinates");
+
+public:
+    /**
+     * @param path The file to create or overwrite
+     * @param chunk_size Segments per chunk
+     * @param compress Whether to XOR-encode columns where that is smaller
+     * @throws std::invalid_argument if chunk_size is 0
+     * @throws std::runtime_error if the file cannot be created
+     */
+    explicit SegmentFileWriter(const std::string& path, size_t chunk_size = 1 << 16, bool compress = false)
+        : path_(path), chunk_size_(chunk_size), compress_(compress) {
+        if (chunk_size == 0) throw std::invalid_argument("Chunk size must be positive");
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) fail("Cannot create");
+        for (auto& column : columns_) {
+            column.reserve(chunk_size);
+        }
+        offset_ = sizeof(SegmentFileHeader);
+    }
+
+    SegmentFileWriter(const SegmentFileWriter&) = delete;
+    SegmentFileWriter& operator=(const SegmentFileWriter&) = delete;
+
+    ~SegmentFileWriter() {
+        try {
+            close();
+        } catch (...) {
+            // Leave the incomplete file, but release the mapping and descriptor.
+            if (map_ != nullptr) ::munmap(map_, capacity_);
+            ::close(fd_);
+        }
+    }
+
+    /**
+     * @brief Appends a segment, writing a chunk to the file when it is full.
+     * @throws std::runtime_error if the file cannot grow, e.g. the disk is full
+     */
+    void write(const LineSegment<T, Dim>& segment) {
+        for (size_t i = 0; i < Dim; ++i) {
+            columns_[i].push_back(segment.start()[i]);
+            columns_[Dim + i].push_back(segment.end()[i]);
+        }
+        if (columns_[0].size() == chunk_size_) flush();
+    }
+
+    void write(const std::vector<LineSegment<T, Dim>>& segments) {
+        for (const LineSegment<T, Dim>& segment : segments) {
+            write(segment);
+        }
+    }
+
+    size_t num_segments() const { return num_segments_ + columns_[0].size(); }
+
+    /**
+     * @brief Writes the last chunk, the index and the header, and closes the
+     * file. Called by the destructor if needed.
+     * @throws std::runtime_error on I/O errors
+     */
+    void close() {
+        if (fd_ < 0) return;
+        flush();
+        offset_ = align(offset_);
+        const size_t index_bytes = index_.size() * sizeof(ChunkHeader);
+        reserve(offset_ + index_bytes);
+        if (index_bytes > 0) std::memcpy(map_ + offset_, index_.data(), index_bytes);
+
+        SegmentFileHeader header{};
+        std::memcpy(header.magic, kSegmentFileMagic, sizeof(kSegmentFileMagic));
+        header.version = kSegmentFileVersion;
+        header.dimension = Dim;
+        header.scalar_bytes = sizeof(T);
+        header.num_segments = num_segments_;
+        header.num_chunks = index_.size();
+        header.index_offset = offset_;
+        std::memcpy(map_, &header, sizeof(header));
+        offset_ += index_bytes;
+
+        ::munmap(map_, capacity_);
+        map_ = nullptr;
+        const int status = ::ftruncate(fd_, static_cast<off_t>(offset_));
+        ::close(fd_);
+        fd_ = -1;
+        if (status != 0) fail("Cannot truncate");
+    }
+
+private:
+    std::string path_;
+    size_t chunk_size_;
+    bool compress_;
+    int fd_ = -1;
+    uint8_t* map_ = nullptr;
+    size_t capacity_ = 0;
+    size_t offset_ = 0;
+    size_t num_segments_ = 0;
+    std::array<std::vector<T>, 2 * Dim> columns_;
+    std::vector<ChunkHeader> index_;
+    std::vector<uint8_t> encoded_;
+
+    static size_t align(size_t offset) {
+        return (offset + kSegmentFileAlignment - 1) / kSegmentFileAlignment * kSegmentFileAlignment;
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error(what + " " + path_ + ": " + std::strerror(errno));
+    }
+
+    // Grows the file and the mapping, doubling, to at least size bytes. The
+    // new range is allocated on disk before it is mapped: a sparse file
+    // would only run out of space on a store through the mapping, which
+    // raises SIGBUS instead of an error.
+    void reserve(size_t size) {
+        if (size <= capacity_) return;
+        const size_t capacity = std::max({size, 2 * capacity_, size_t{1} << 20});
+        const int status = ::posix_fallocate(fd_, static_cast<off_t>(capacity_),
+                                             static_cast<off_t>(capacity - capacity_));
+        if (status != 0) {
+            errno = status;
+            fail("Cannot grow");
+        }
+        if (map_ != nullptr) ::munmap(map_, capacity_);
+        map_ = nullptr;
+        capacity_ = 0;
+        void* map = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) fail("Cannot map");
+        map_ = static_cast<uint8_t*>(map);
+        capacity_ = capacity;
+    }
+
+    void flush() {
+        const size_t count = columns_[0].size();
+        if (count == 0) return;
+        ChunkHeader chunk{};
+        chunk.first_segment = num_segments_;
+        chunk.count = count;
+        for (size_t i = 0; i < 3; ++i) {
+            chunk.min[i] = i < Dim ? std::numeric_limits<double>::infinity() : 0;
+            chunk.max[i] = i < Dim ? -std::numeric_limits<double>::infinity() : 0;
+        }
+        for (size_t c = 0; c < 2 * Dim; ++c) {
+            const size_t axis = c % Dim;
+            for (T value : columns_[c]) {
+                chunk.min[axis] = std::min<double>(chunk.min[axis], value);
+                chunk.max[axis] = std::max<double>(chunk.max[axis], value);
+            }
+
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(columns_[c].data());
+            size_t bytes = count * sizeof(T);
+            ColumnEncoding encoding = ColumnEncoding::kRaw;
+            if (compress_) {
+                encoded_.clear();
+                encode_xor_column(columns_[c].data(), count, encoded_);
+                if (encoded_.size() < bytes) {
+                    data = encoded_.data();
+                    bytes = encoded_.size();
+                    encoding = ColumnEncoding::kXor;
+                }
+            }
+            offset_ = align(offset_);
+            reserve(offset_ + bytes);
+            std::memcpy(map_ + offset_, data, bytes);
+            chunk.columns[c] = ColumnHeader{offset_, bytes, encoding, 0};
+            offset_ += bytes;
+            columns_[c].clear();
+        }
+        index_.push_back(chunk);
+        num_segments_ += count;
+    }
+};
+
+/**
+ * @brief Reads a segment file through a read-only memory mapping. The chunk
+ * index is read up front; chunk data is only paged in when a chunk is read,
+ * and evict() lets a streaming reader drop pages it is done with.
+ */
+template <typename T, size_t Dim>
+class SegmentFileReader {
+    static_assert(Dim == 2 || Dim == 3, "Segment files hold 2D or 3D segments");
+
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be mapped, is not a
+     * segment file, does not hold Dim-dimensional segments of type T, or its
+     * index is out of bounds or does not cover the segments in order
+     */
+    explicit SegmentFileReader(const std::string& path): path_(path) {
+        header_ = read_segment_file_header(path);
+        if (header_.dimension != Dim || header_.scalar_bytes != sizeof(T)) {
+            throw std::runtime_error(path + " holds " + std::to_string(header_.dimension) + "D segments of " +
+                                     std::to_string(header_.scalar_bytes) + "-byte scalars");
+        }
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(errno));
+        }
+        const size_t size = static_cast<size_t>(info.st_size);
+        void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) throw std::runtime_error("Cannot map " + path + ": " + std::strerror(errno));
+        // From here on the mapping is released by map_ if validation throws.
+        map_.data = static_cast<const uint8_t*>(map);
+        map_.size = size;
+
+        if (header_.index_offset > size ||
+            header_.num_chunks > (size - header_.index_offset) / sizeof(ChunkHeader)) {
+            throw_corrupt();
+        }
+        index_.resize(header_.num_chunks);
+        std::memcpy(index_.data(), map_.data + header_.index_offset, index_.size() * sizeof(ChunkHeader));
+        // Chunks must cover the segments in order, and every column must lie
+        // in the file and hold at least its count of values: raw columns
+        // exactly count values, XOR columns at least one byte per value.
+        uint64_t next = 0;
+        for (const ChunkHeader& chunk : index_) {
+            if (chunk.first_segment != next || chunk.count > header_.num_segments - next) throw_corrupt();
+            next += chunk.count;
+            for (size_t c = 0; c < 2 * Dim; ++c) {
+                const ColumnHeader& column = chunk.columns[c];
+                if (column.offset > size || column.bytes > size - column.offset) throw_corrupt();
+                if (column.encoding == ColumnEncoding::kRaw) {
+                    if (column.bytes / sizeof(T) != chunk.count || column.bytes % sizeof(T) != 0) throw_corrupt();
+                } else if (column.encoding == ColumnEncoding::kXor) {
+                    if (column.bytes < chunk.count) throw_corrupt();
+                } else {
+                    throw_corrupt();
+                }
+            }
+        }
+        if (next != header_.num_segments) throw_corrupt();
+    }
+
+    SegmentFileReader(const SegmentFileReader&) = delete;
+    SegmentFileReader& operator=(const SegmentFileReader&) = delete;
+
+    size_t num_segments() const { return header_.num_segments; }
+
+    size_t num_chunks() const { return index_.size(); }
+
+    const ChunkHeader& chunk(size_t c) const { return index_[c]; }
+
+    BoundingBox<T, Dim> chunk_bounds(size_t c) const {
+        Point<T, Dim> min, max;
+        for (size_t i = 0; i < Dim; ++i) {
+            min[i] = static_cast<T>(index_[c].min[i]);
+            max[i] = static_cast<T>(index_[c].max[i]);
+        }
+        return BoundingBox<T, Dim>(min, max);
+    }
+
+    /**
+     * @brief Decodes one chunk.
+     * @param c The chunk
+     * @param segments Receives the chunk's segments; reused across calls
+     * @throws std::runtime_error if an XOR column is corrupt
+     */
+    void read_chunk(size_t c, std::vector<LineSegment<T, Dim>>& segments) const {
+        const ChunkHeader& chunk = index_[c];
+        const size_t count = chunk.count;
+        std::array<std::vector<T>, 2 * Dim>& columns = scratch();
+        for (size_t k = 0; k < 2 * Dim; ++k) {
+            const ColumnHeader& column = chunk.columns[k];
+            columns[k].resize(count);
+            if (column.encoding == ColumnEncoding::kRaw) {
+                std::memcpy(columns[k].data(), map_.data + column.offset, count * sizeof(T));
+            } else {
+                decode_xor_column(map_.data + column.offset, column.bytes, count, columns[k].data());
+            }
+        }
+        segments.resize(count);
+        for (size_t s = 0; s < count; ++s) {
+            Point<T, Dim> start, end;
+            for (size_t i = 0; i < Dim; ++i) {
+                start[i] = columns[i][s];
+                end[i] = columns[Dim + i][s];
+            }
+            segments[s] = LineSegment<T, Dim>(start, end);
+        }
+    }
+
+    /**
+     * @brief Lets the kernel drop the pages of a chunk from memory; they are
+     * read from the file again if the chunk is read again.
+     */
+    void evict(size_t c) const {
+        const ChunkHeader& chunk = index_[c];
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t begin = chunk.columns[0].offset;
+        size_t end = begin;
+        for (size_t k = 0; k < 2 * Dim; ++k) {
+            begin = std::min<size_t>(begin, chunk.columns[k].offset);
+            end = std::max<size_t>(end, chunk.columns[k].offset + chunk.columns[k].bytes);
+        }
+        // Only whole pages inside the chunk, which neighbours may share.
+        begin = (begin + page - 1) / page * page;
+        end = end / page * page;
+        if (begin < end) ::madvise(const_cast<uint8_t*>(map_.data) + begin, end - begin, MADV_DONTNEED);
+    }
+
+private:
+    // Unmaps the file when the reader is destroyed or its constructor throws.
+    struct Mapping {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+
+        Mapping() = default;
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+        ~Mapping() {
+            if (data != nullptr) ::munmap(const_cast<uint8_t*>(data), size);
+        }
+    };
+
+    std::string path_;
+    SegmentFileHeader header_;
+    Mapping map_;
+    std::vector<ChunkHeader> index_;
+
+    // Per-thread column buffers, so that chunks can be read concurrently.
+    static std::array<std::vector<T>, 2 * Dim>& scratch() {
+        static thread_local std::array<std::vector<T>, 2 * Dim> columns;
+        return columns;
+    }
+
+    [[noreturn]] void throw_corrupt() const { throw std::runtime_error(path_ + " is corrupt"); }
+};
+
+} // namespace geometry
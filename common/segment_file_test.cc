@@ -0,0 +1,208 @@
+#include <cmath>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include "line_segment_plane_intersection.hh"
+#include "segment_file.hh"
+
+namespace {
+
+template <typename T, size_t Dim>
+bool same(const geometry::LineSegment<T, Dim>& a, const geometry::LineSegment<T, Dim>& b) {
+    for (size_t i = 0; i < Dim; ++i) {
+        if (a.start()[i] != b.start()[i] || a.end()[i] != b.end()[i]) return false;
+    }
+    return true;
+}
+
+// Reads a whole file back chunk by chunk.
+template <typename T, size_t Dim>
+std::vector<geometry::LineSegment<T, Dim>> read_all(const geometry::SegmentFileReader<T, Dim>& reader) {
+    std::vector<geometry::LineSegment<T, Dim>> all, chunk;
+    for (size_t c = 0; c < reader.num_chunks(); ++c) {
+        reader.read_chunk(c, chunk);
+        all.insert(all.end(), chunk.begin(), chunk.end());
+        reader.evict(c);
+    }
+    return all;
+}
+
+size_t file_size(const std::string& path) {
+    struct stat info;
+    return ::stat(path.c_str(), &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+}
+
+}  // namespace
+
+int main() {
+    using namespace geometry;
+
+    const std::string raw_path = "segment_file_test_raw.seg";
+    const std::string packed_path = "segment_file_test_packed.seg";
+    std::mt19937 rng(40);
+    std::uniform_real_distribution<double> coordinate(-1, 1);
+
+    // Test case 1: Round trip of random 3D segments, with a partial last chunk
+    std::vector<LineSegment<double, 3>> random(100003);
+    for (auto& s : random) {
+        s = LineSegment<double, 3>(Point<double, 3>(coordinate(rng), coordinate(rng), coordinate(rng)),
+                                   Point<double, 3>(coordinate(rng), coordinate(rng), coordinate(rng)));
+    }
+    {
+        SegmentFileWriter<double, 3> writer(raw_path, 4096, true);
+        writer.write(random);
+    }
+    SegmentFileReader<double, 3> reader(raw_path);
+    auto read = read_all(reader);
+    bool round_trip = read.size() == random.size();
+    for (size_t i = 0; round_trip && i < read.size(); ++i) {
+        round_trip = same(read[i], random[i]);
+    }
+    std::cout << "Test 1 - Round trip:" << std::endl;
+    std::cout << reader.num_segments() << " segments in " << reader.num_chunks() << " chunks" << std::endl;
+    std::cout << "Segments read back unchanged? " << (round_trip ? "Yes" : "No") << std::endl;
+    bool kept_raw = reader.chunk(0).columns[0].encoding == ColumnEncoding::kRaw;
+    std::cout << "Random columns kept raw? " << (kept_raw ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: Chunk boxes contain their segments
+    bool contained = true;
+    std::vector<LineSegment<double, 3>> chunk;
+    for (size_t c = 0; c < reader.num_chunks(); ++c) {
+        reader.read_chunk(c, chunk);
+        BoundingBox<double, 3> bounds = reader.chunk_bounds(c);
+        for (const auto& s : chunk) {
+            contained = contained && bounds.contains(s.start()) && bounds.contains(s.end());
+        }
+    }
+    std::cout << "Test 2 - Chunk bounds:" << std::endl;
+    std::cout << "Every segment inside its chunk box? " << (contained ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: A polyline on a millimetre grid compresses losslessly
+    std::vector<LineSegment<float, 2>> path;
+    Point<float, 2> previous(0, 0);
+    std::uniform_int_distribution<int> step(-5, 5);
+    for (int i = 0; i < 200000; ++i) {
+        Point<float, 2> next(std::round((previous[0] + step(rng) * 0.001f) * 1000) / 1000,
+                             std::round((previous[1] + step(rng) * 0.001f) * 1000) / 1000);
+        path.emplace_back(previous, next);
+        previous = next;
+    }
+    {
+        SegmentFileWriter<float, 2> plain(raw_path, 1 << 16);
+        plain.write(path);
+        SegmentFileWriter<float, 2> packed(packed_path, 1 << 16, true);
+        packed.write(path);
+    }
+    SegmentFileReader<float, 2> packed_reader(packed_path);
+    auto unpacked = read_all(packed_reader);
+    bool lossless = unpacked.size() == path.size();
+    for (size_t i = 0; lossless && i < path.size(); ++i) {
+        lossless = same(unpacked[i], path[i]);
+    }
+    std::cout << "Test 3 - Column compression:" << std::endl;
+    std::cout << "Compressed to " << 100 * file_size(packed_path) / file_size(raw_path) << "% of raw" << std::endl;
+    std::cout << "Smaller than raw? " << (file_size(packed_path) < file_size(raw_path) ? "Yes" : "No") << std::endl;
+    std::cout << "Lossless? " << (lossless ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 4: Streaming a plane query with chunk skipping, against the
+    // batch kernel on all segments at once
+    std::vector<LineSegment<double, 3>> sorted(100000);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        Point<double, 3> start(coordinate(rng), coordinate(rng), 10.0 * i / sorted.size());
+        sorted[i] = LineSegment<double, 3>(start, start + Point<double, 3>(0.01, 0.01, 0.01));
+    }
+    {
+        SegmentFileWriter<double, 3> writer(raw_path, 1000);
+        writer.write(sorted);
+    }
+    Plane<double> plane(Point<double, 3>(0, 0, 5), Point<double, 3>(0, 0, 1));
+    SegmentFileReader<double, 3> sorted_reader(raw_path);
+    std::vector<uint8_t> streamed;
+    size_t skipped = 0;
+    for (size_t c = 0; c < sorted_reader.num_chunks(); ++c) {
+        const ChunkHeader& header = sorted_reader.chunk(c);
+        if (header.min[2] > 5 || header.max[2] < 5) {
+            streamed.insert(streamed.end(), header.count, 0);
+            ++skipped;
+            continue;
+        }
+        sorted_reader.read_chunk(c, chunk);
+        auto hits = do_intersect_mixed(chunk, plane);
+        streamed.insert(streamed.end(), hits.begin(), hits.end());
+    }
+    std::cout << "Test 4 - Streaming plane query:" << std::endl;
+    std::cout << "Skipped " << skipped << " of " << sorted_reader.num_chunks() << " chunks" << std::endl;
+    std::cout << "Matches the batch kernel? " << (streamed == do_intersect_mixed(sorted, plane) ? "Yes" : "No")
+              << std::endl;
+    std::cout << std::endl;
+
+    // Test case 5: Files of the wrong kind are rejected
+    bool rejected = false;
+    try {
+        SegmentFileReader<double, 2> wrong(raw_path);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    std::cout << "Test 5 - Validation:" << std::endl;
+    std::cout << "3D file rejected as 2D? " << (rejected ? "Yes" : "No") << std::endl;
+
+    // A chunk count far beyond the file, in a compressed file whose XOR
+    // columns have no size implied by the count
+    {
+        SegmentFileWriter<float, 2> packed(packed_path, 1 << 16, true);
+        packed.write(path);
+    }
+    const uint64_t huge_count = uint64_t{1} << 60;
+    {
+        std::fstream file(packed_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(read_segment_file_header(packed_path).index_offset +
+                                               offsetof(ChunkHeader, count)));
+        file.write(reinterpret_cast<const char*>(&huge_count), sizeof(huge_count));
+    }
+    bool corrupt_rejected = false;
+    try {
+        SegmentFileReader<float, 2> corrupt(packed_path);
+    } catch (const std::runtime_error&) {
+        corrupt_rejected = true;
+    }
+    std::cout << "Corrupt chunk count rejected? " << (corrupt_rejected ? "Yes" : "No") << std::endl;
+
+    std::cout << std::endl;
+
+    // Test case 6: A file that cannot grow, here past a file size limit as
+    // when the disk is full, fails with an error rather than a signal
+    struct rlimit saved;
+    ::getrlimit(RLIMIT_FSIZE, &saved);
+    struct rlimit limited = saved;
+    limited.rlim_cur = 1 << 20;
+    std::signal(SIGXFSZ, SIG_IGN);
+    ::setrlimit(RLIMIT_FSIZE, &limited);
+    bool write_failed = false;
+    try {
+        SegmentFileWriter<double, 3> writer(raw_path, 4096);
+        writer.write(random);
+        writer.close();
+    } catch (const std::runtime_error&) {
+        write_failed = true;
+    }
+    ::setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, SIG_DFL);
+    std::cout << "Test 6 - Write errors:" << std::endl;
+    std::cout << "Growing past the size limit throws? " << (write_failed ? "Yes" : "No") << std::endl;
+
+    std::remove(raw_path.c_str());
+    std::remove(packed_path.c_str());
+    return 0;
+}
@@ -0,0 +1,252 @@
+// Converts text segment lists to columnar segment files and streams segment
+// files through the batch intersection kernels.
+//
+// Usage:
+//   segment_query convert <2|3> <input.txt> <output.seg> [--chunk N] [--compress]
+//       Reads one segment per line, "x1 y1 x2 y2" or "x1 y1 z1 x2 y2 z2".
+//   segment_query info <file.seg>
+//   segment_query plane <file.seg> px py pz nx ny nz [--threads N] [--ids]
+//       Finds the 3D segments that intersect the plane through p with normal n.
+//   segment_query segments <file.seg> <queries.txt> [--threads N] [--ids]
+//       Finds the 2D segments that intersect any segment of a text list.
+//
+// Queries read a window of one chunk per thread at a time, skip chunks whose
+// bounding box cannot reach the query, and drop the pages of every chunk once
+// it is done, so memory stays at a few chunks whatever the file size. The
+// number of hits is printed to stderr with the throughput; --ids prints the
+// index of every hit to stdout.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/dynamic_aabb_tree.hh"
+#include "common/line_segment_intersection.hh"
+#include "common/line_segment_plane_intersection.hh"
+#include "common/segment_file.hh"
+#include "common/thread_pool.hh"
+
+namespace {
+
+using namespace geometry;
+
+// Above this many candidate queries in a chunk, each segment looks up its
+// own candidates in the query tree instead of running every candidate's
+// batch test over the whole chunk.
+constexpr size_t kMaxBatchQueries = 16;
+
+struct Options {
+    std::vector<std::string> arguments;
+    size_t chunk_size = 1 << 16;
+    bool compress = false;
+    size_t num_threads = std::thread::hardware_concurrency();
+    bool ids = false;
+};
+
+Options parse(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--chunk" && i + 1 < argc) {
+            options.chunk_size = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argument == "--threads" && i + 1 < argc) {
+            options.num_threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argument == "--compress") {
+            options.compress = true;
+        } else if (argument == "--ids") {
+            options.ids = true;
+        } else {
+            options.arguments.push_back(argument);
+        }
+    }
+    return options;
+}
+
+// Parses "x1 y1 [z1] x2 y2 [z2]"; false if the line holds no segment.
+template <size_t Dim>
+bool parse_segment(const std::string& line, LineSegment<double, Dim>& segment) {
+    std::istringstream fields(line);
+    Point<double, Dim> start, end;
+    for (size_t i = 0; i < Dim; ++i) fields >> start[i];
+    for (size_t i = 0; i < Dim; ++i) fields >> end[i];
+    if (!fields) return false;
+    segment = LineSegment<double, Dim>(start, end);
+    return true;
+}
+
+template <size_t Dim>
+std::vector<LineSegment<double, Dim>> read_text(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    std::vector<LineSegment<double, Dim>> segments;
+    std::string line;
+    LineSegment<double, Dim> segment;
+    while (std::getline(in, line)) {
+        if (parse_segment(line, segment)) segments.push_back(segment);
+    }
+    return segments;
+}
+
+template <size_t Dim>
+size_t convert(const Options& options) {
+    std::ifstream in(options.arguments[2]);
+    if (!in) throw std::runtime_error("Cannot open " + options.arguments[2]);
+    SegmentFileWriter<double, Dim> writer(options.arguments[3], options.chunk_size, options.compress);
+    std::string line;
+    LineSegment<double, Dim> segment;
+    while (std::getline(in, line)) {
+        if (parse_segment(line, segment)) writer.write(segment);
+    }
+    writer.close();
+    return writer.num_segments();
+}
+
+/**
+ * @brief Streams every chunk of a file through match(chunk, segments, hits),
+ * one window of chunks per round with one chunk per thread, and reports the
+ * hits in file order.
+ * @return The number of hits
+ */
+template <size_t Dim, typename Match>
+size_t stream(const SegmentFileReader<double, Dim>& reader, const Options& options, Match match) {
+    Executor executor(options.num_threads);
+    const size_t window = executor.num_threads();
+    std::vector<std::vector<LineSegment<double, Dim>>> segments(window);
+    std::vector<std::vector<uint8_t>> hits(window);
+    size_t total = 0;
+    for (size_t first = 0; first < reader.num_chunks(); first += window) {
+        const size_t count = std::min(window, reader.num_chunks() - first);
+        executor.pool().run(count, [&](size_t slot) {
+            const size_t c = first + slot;
+            hits[slot].clear();
+            if (match(c, segments[slot], hits[slot])) reader.evict(c);
+        });
+        for (size_t slot = 0; slot < count; ++slot) {
+            const uint64_t base = reader.chunk(first + slot).first_segment;
+            for (size_t i = 0; i < hits[slot].size(); ++i) {
+                if (!hits[slot][i]) continue;
+                ++total;
+                if (options.ids) std::cout << base + i << '\n';
+            }
+        }
+    }
+    return total;
+}
+
+size_t query_plane(const Options& options) {
+    SegmentFileReader<double, 3> reader(options.arguments[1]);
+    double v[6];
+    for (size_t i = 0; i < 6; ++i) {
+        v[i] = std::strtod(options.arguments[2 + i].c_str(), nullptr);
+    }
+    const Plane<double> plane(Point<double, 3>(v[0], v[1], v[2]), Point<double, 3>(v[3], v[4], v[5]));
+    const double tolerance = 1e-9;
+    return stream(reader, options, [&](size_t c, std::vector<LineSegment<double, 3>>& segments,
+                                       std::vector<uint8_t>& hits) {
+        // Skip the chunk if its box lies farther from the plane than its
+        // projected half extent.
+        const ChunkHeader& chunk = reader.chunk(c);
+        double center = 0, radius = 0;
+        for (size_t i = 0; i < 3; ++i) {
+            center += plane.normal()[i] * ((chunk.min[i] + chunk.max[i]) / 2 - plane.point()[i]);
+            radius += std::abs(plane.normal()[i]) * (chunk.max[i] - chunk.min[i]) / 2;
+        }
+        if (std::abs(center) > radius + tolerance) return false;
+        reader.read_chunk(c, segments);
+        hits = do_intersect_mixed(segments, plane, nullptr, tolerance);
+        return true;
+    });
+}
+
+size_t query_segments(const Options& options) {
+    SegmentFileReader<double, 2> reader(options.arguments[1]);
+    const std::vector<LineSegment<double, 2>> queries = read_text<2>(options.arguments[2]);
+    DynamicAabbTree<double, 2> tree(0, 0);
+    for (const LineSegment<double, 2>& query : queries) {
+        tree.insert(query);
+    }
+    return stream(reader, options, [&](size_t c, std::vector<LineSegment<double, 2>>& segments,
+                                       std::vector<uint8_t>& hits) {
+        std::vector<int32_t> candidates;
+        tree.query(reader.chunk_bounds(c), [&](int32_t proxy) {
+            candidates.push_back(proxy);
+            return true;
+        });
+        if (candidates.empty()) return false;
+        reader.read_chunk(c, segments);
+        if (candidates.size() <= kMaxBatchQueries) {
+            hits.assign(segments.size(), 0);
+            for (int32_t proxy : candidates) {
+                std::vector<uint8_t> found = do_intersect_mixed(segments, tree.segment(proxy));
+                for (size_t i = 0; i < found.size(); ++i) {
+                    hits[i] |= found[i];
+                }
+            }
+            return true;
+        }
+        hits.resize(segments.size());
+        for (size_t i = 0; i < segments.size(); ++i) {
+            BoundingBox<double, 2> box;
+            box.expand(segments[i].start());
+            box.expand(segments[i].end());
+            bool hit = false;
+            tree.query(box, [&](int32_t proxy) {
+                hit = do_intersect_mixed(segments[i], tree.segment(proxy));
+                return !hit;
+            });
+            hits[i] = hit;
+        }
+        return true;
+    });
+}
+
+int usage() {
+    std::cerr << "Usage:\n"
+              << "  segment_query convert <2|3> <input.txt> <output.seg> [--chunk N] [--compress]\n"
+              << "  segment_query info <file.seg>\n"
+              << "  segment_query plane <file.seg> px py pz nx ny nz [--threads N] [--ids]\n"
+              << "  segment_query segments <file.seg> <queries.txt> [--threads N] [--ids]\n";
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parse(argc, argv);
+    const std::vector<std::string>& arguments = options.arguments;
+    if (arguments.empty()) return usage();
+    const std::string& command = arguments[0];
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        if (command == "convert" && arguments.size() == 4) {
+            const size_t count = arguments[1] == "2" ? convert<2>(options) : convert<3>(options);
+            std::cerr << "Wrote " << count << " segments" << std::endl;
+        } else if (command == "info" && arguments.size() == 2) {
+            const SegmentFileHeader header = read_segment_file_header(arguments[1]);
+            std::cout << header.num_segments << " " << header.dimension << "D segments of "
+                      << header.scalar_bytes << "-byte scalars in " << header.num_chunks << " chunks" << std::endl;
+        } else if ((command == "plane" && arguments.size() == 8) || (command == "segments" && arguments.size() == 3)) {
+            const size_t hits = command == "plane" ? query_plane(options) : query_segments(options);
+            const double seconds =
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const SegmentFileHeader header = read_segment_file_header(arguments[1]);
+            const double bytes = static_cast<double>(header.index_offset);
+            std::cerr << hits << " of " << header.num_segments << " segments hit in " << seconds << " s ("
+                      << bytes / seconds / (1 << 20) << " MiB/s effective)" << std::endl;
+        } else {
+            return usage();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+// Author: HW
+
+#pragma once
+
+// Opt-in SIMD layout for Point<float, Dim> and Point<double, Dim>, Dim = 2..4.
+//
+// Enabled by building with --define geometry_simd=true (which defines
+// GEOMETRY_SIMD_POINT for everything depending on //common:point). The
+// coordinates are then stored in aligned register-sized blocks, with 3D points
+// padded to four lanes. Expressions of +, - and scalar * on such points are
+// still fused by the expression templates in point.hh, but each node is
+// evaluated as one SSE/AVX instruction when the expression is assigned to a
+// Point, and dot_product and cross_product work on registers too. Build with
+// --copt=-mavx (or -mavx2) to use 256-bit registers for double.
+//
+// The interface of Point is unchanged, so LineSegment, Plane, Simplex and
+// Surface work with either layout. The padding lanes are always zero.
+
+#include "common/point.hh"
+
+#if defined(GEOMETRY_SIMD_POINT) && defined(__SSE2__)
+
+#include <immintrin.h>
+
+namespace geometry {
+
+// --- Layouts ---
+
+template <>
+struct PointLayout<float, 2> {
+  static constexpr size_t kLanes = 2;
+  static constexpr size_t kAlignment = 8;
+};
+
+template <>
+struct PointLayout<float, 3> {
+  static constexpr size_t kLanes = 4;
+  static constexpr size_t kAlignment = 16;
+};
+
+template <>
+struct PointLayout<float, 4> {
+  static constexpr size_t kLanes = 4;
+  static constexpr size_t kAlignment = 16;
+};
+
+template <>
+struct PointLayout<double, 2> {
+  static constexpr size_t kLanes = 2;
+  static constexpr size_t kAlignment = 16;
+};
+
+template <>
+struct PointLayout<double, 3> {
+  static constexpr size_t kLanes = 4;
+  static constexpr size_t kAlignment = 32;
+};
+
+template <>
+struct PointLayout<double, 4> {
+  static constexpr size_t kLanes = 4;
+  static constexpr size_t kAlignment = 32;
+};
+
+// --- Register operations ---
+//
+// Every specialization of SimdLanes (declared in point.hh) provides load/store
+// of the coordinate block, lane-wise add/sub/mul, splat of a scalar (zero in
+// the padding lanes) and a horizontal sum of the lanes; 3D layouts with
+// kHasCross also provide the (y, z, x) rotation used by the cross product.
+
+// Point<float, 2>: the coordinates occupy the low 64 bits of an SSE register.
+template <>
+struct SimdLanes<float, 2> {
+  static constexpr bool kEnabled = true;
+  static constexpr bool kHasCross = false;
+  using Register = __m128;
+
+  static Register load(const float* p) {
+    return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p)));
+  }
+  static void store(float* p, Register r) {
+    _mm_store_sd(reinterpret_cast<double*>(p), _mm_castps_pd(r));
+  }
+  static Register splat(float s) { return _mm_set_ps(0.0f, 0.0f, s, s); }
+  static Register add(Register a, Register b) { return _mm_add_ps(a, b); }
+  static Register sub(Register a, Register b) { return _mm_sub_ps(a, b); }
+  static Register mul(Register a, Register b) { return _mm_mul_ps(a, b); }
+  static float sum(Register r) {
+    return _mm_cvtss_f32(_mm_add_ss(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+};
+
+// Point<float, 3> and Point<float, 4>: one SSE register.
+template <size_t Dim>
+struct SseFloatLanes {
+  static constexpr bool kEnabled = true;
+  static constexpr bool kHasCross = (Dim == 3);
+  using Register = __m128;
+
+  static Register load(const float* p) { return _mm_load_ps(p); }
+  static void store(float* p, Register r) { _mm_store_ps(p, r); }
+  static Register splat(float s) { return _mm_set_ps(Dim == 4 ? s : 0.0f, s, s, s); }
+  static Register add(Register a, Register b) { return _mm_add_ps(a, b); }
+  static Register sub(Register a, Register b) { return _mm_sub_ps(a, b); }
+  static Register mul(Register a, Register b) { return _mm_mul_ps(a, b); }
+  static float sum(Register r) {
+    Register shuffled = _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 3, 0, 1));
+    Register sums = _mm_add_ps(r, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+  }
+  // (y, z, x, w) permutation used by the cross product.
+  static Register rotate(Register r) { return _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 0, 2, 1)); }
+};
+
+template <>
+struct SimdLanes<float, 3> : SseFloatLanes<3> {};
+
+template <>
+struct SimdLanes<float, 4> : SseFloatLanes<4> {};
+
+// Point<double, 2>: one SSE register.
+template <>
+struct SimdLanes<double, 2> {
+  static constexpr bool kEnabled = true;
+  static constexpr bool kHasCross = false;
+  using Register = __m128d;
+
+  static Register load(const double* p) { return _mm_load_pd(p); }
+  static void store(double* p, Register r) { _mm_store_pd(p, r); }
+  static Register splat(double s) { return _mm_set1_pd(s); }
+  static Register add(Register a, Register b) { return _mm_add_pd(a, b); }
+  static Register sub(Register a, Register b) { return _mm_sub_pd(a, b); }
+  static Register mul(Register a, Register b) { return _mm_mul_pd(a, b); }
+  static double sum(Register r) { return _mm_cvtsd_f64(_mm_add_sd(r, _mm_unpackhi_pd(r, r))); }
+};
+
+#if defined(__AVX__)
+
+// Point<double, 3> and Point<double, 4>: one AVX register.
+template <size_t Dim>
+struct AvxDoubleLanes {
+  static constexpr bool kEnabled = true;
+#if defined(__AVX2__)
+  static constexpr bool kHasCross = (Dim == 3);
+#else
+  static constexpr bool kHasCross = false;
+#endif
+  using Register = __m256d;
+
+  static Register load(const double* p) { return _mm256_load_pd(p); }
+  static void store(double* p, Register r) { _mm256_store_pd(p, r); }
+  static Register splat(double s) { return _mm256_set_pd(Dim == 4 ? s : 0.0, s, s, s); }
+  static Register add(Register a, Register b) { return _mm256_add_pd(a, b); }
+  static Register sub(Register a, Register b) { return _mm256_sub_pd(a, b); }
+  static Register mul(Register a, Register b) { return _mm256_mul_pd(a, b); }
+  static double sum(Register r) {
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(r), _mm256_extractf128_pd(r, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+  }
+#if defined(__AVX2__)
+  static Register rotate(Register r) { return _mm256_permute4x64_pd(r, _MM_SHUFFLE(3, 0, 2, 1)); }
+#endif
+};
+
+#else
+
+// Point<double, 3> and Point<double, 4> without AVX: a pair of SSE registers.
+template <size_t Dim>
+struct AvxDoubleLanes {
+  static constexpr bool kEnabled = true;
+  static constexpr bool kHasCross = false;
+  struct Register {
+    __m128d low;
+    __m128d high;
+  };
+
+  static Register load(const double* p) { return {_mm_load_pd(p), _mm_load_pd(p + 2)}; }
+  static void store(double* p, Register r) {
+    _mm_store_pd(p, r.low);
+    _mm_store_pd(p + 2, r.high);
+  }
+  static Register splat(double s) { return {_mm_set1_pd(s), _mm_set_pd(Dim == 4 ? s : 0.0, s)}; }
+  static Register add(Register a, Register b) {
+    return {_mm_add_pd(a.low, b.low), _mm_add_pd(a.high, b.high)};
+  }
+  static Register sub(Register a, Register b) {
+    return {_mm_sub_pd(a.low, b.low), _mm_sub_pd(a.high, b.high)};
+  }
+  static Register mul(Register a, Register b) {
+    return {_mm_mul_pd(a.low, b.low), _mm_mul_pd(a.high, b.high)};
+  }
+  static double sum(Register r) {
+    __m128d half = _mm_add_pd(r.low, r.high);
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+  }
+};
+
+#endif  // __AVX__
+
+template <>
+struct SimdLanes<double, 3> : AvxDoubleLanes<3> {};
+
+template <>
+struct SimdLanes<double, 4> : AvxDoubleLanes<4> {};
+
+} // namespace geometry
+
+#endif  // GEOMETRY_SIMD_POINT && __SSE2__
@@ -2,8 +2,10 @@
 
 #pragma once
 
+#include <array>
 #include <numeric>
 
+#include "common/barycentric_frame.hh"
 #include "common/point.hh"
 
 namespace geometry {
@@ -21,13 +23,13 @@ public:
     Simplex() = default;
 
     // Construct a simplex from K points
-    Simplex(const std::array<Point<T, K>, K>& verts) : vertices(verts) {}
+    constexpr Simplex(const std::array<Point<T, K>, K>& verts) : vertices(verts) {}
 
     /**
      * @brief Calculates the centroid (geometric center) of the simplex.
      * @return A new Point representing the centroid.
      */
-    Point<T, K> centroid() const {
+    constexpr Point<T, K> centroid() const {
         Point<T, K> sum; // Starts at (0,0,...)
         for (const auto& v : vertices) {
             for (size_t i = 0; i < K; ++i) {
@@ -41,16 +43,17 @@ public:
         }
         return centroid_point;
     }
-};
 
-// Helper function to calculate the cross product for 3D points
-template <typename T>
-Point<T, 3> cross_product(const Point<T, 3>& a, const Point<T, 3>& b) {
-    return Point<T, 3>(
-        a.y() * b.z() - a.z() * b.y(),
-        a.z() * b.x() - a.x() * b.z(),
-        a.x() * b.y() - a.y() * b.x()
-    );
-}
+    /**
+     * @brief Builds the barycentric frame of the simplex, which holds the
+     * inverted edge matrix. Build it once and keep it to compute barycentric
+     * coordinates or test containment for any number of points; the
+     * simplex itself caches nothing.
+     * @return The precomputed frame
+     */
+    BarycentricFrame<T, K, K> barycentric_frame() const {
+        return BarycentricFrame<T, K, K>(vertices);
+    }
+};
 
 } // namespace geometry
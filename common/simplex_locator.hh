@@ -0,0 +1,198 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "common/barycentric_frame.hh"
+#include "common/bounding_box.hh"
+#include "common/parallel_runs.hh"
+#include "common/point.hh"
+
+namespace geometry {
+
+/**
+ * @brief Point location in a mesh of full-dimensional simplices: triangles in
+ * 2D or tetrahedra in 3D.
+ *
+ * The barycentric frame of every cell is computed once at construction. A
+ * uniform grid over the mesh's bounding box, with about one bucket per cell,
+ * lists the cells whose bounding box overlaps each bucket, so a query only
+ * tests the few cells of one bucket.
+ */
+template <typename T, size_t Dim>
+class SimplexMeshLocator {
+public:
+    // Vertex indices of one cell.
+    using Cell = std::array<uint32_t, Dim + 1>;
+
+    // Returned by locate() for points outside the mesh.
+    static constexpr int32_t kNotFound = -1;
+
+    /**
+     * @brief Precomputes the frames and the bucket grid.
+     * @param vertices The mesh vertices
+     * @param cells The cells, as indices into vertices
+     * @param tolerance Points this close to a cell (in barycentric coordinates) are inside it
+     * @throws std::invalid_argument if a cell is degenerate
+     */
+    SimplexMeshLocator(const std::vector<Point<T, Dim>>& vertices, const std::vector<Cell>& cells,
+                       T tolerance = 1e-9)
+        : tolerance_(tolerance) {
+        frames_.reserve(cells.size());
+        std::vector<BoundingBox<T, Dim>> cell_bounds(cells.size());
+        for (size_t c = 0; c < cells.size(); ++c) {
+            std::array<Point<T, Dim>, Dim + 1> corners;
+            for (size_t i = 0; i <= Dim; ++i) {
+                corners[i] = vertices[cells[c][i]];
+                cell_bounds[c].expand(corners[i]);
+            }
+            frames_.emplace_back(corners);
+            bounds_.expand(cell_bounds[c]);
+        }
+        if (cells.empty()) return;
+
+        // Bucket edge h such that the grid has about one bucket per cell.
+        T volume = 1;
+        for (size_t i = 0; i < Dim; ++i) {
+            volume *= std::max(bounds_.extent(i), std::numeric_limits<T>::min());
+        }
+        T h = std::pow(volume / static_cast<T>(cells.size()), T(1) / Dim);
+        for (size_t i = 0; i < Dim; ++i) {
+            resolution_[i] = std::clamp<size_t>(static_cast<size_t>(bounds_.extent(i) / h), 1, kMaxResolution);
+            inverse_bucket_size_[i] = bounds_.extent(i) > 0 ? resolution_[i] / bounds_.extent(i) : T(0);
+        }
+
+        // Bucket lists in compressed form: count, prefix sum, fill.
+        size_t num_buckets = 1;
+        for (size_t i = 0; i < Dim; ++i) {
+            num_buckets *= resolution_[i];
+        }
+        bucket_offsets_.assign(num_buckets + 1, 0);
+        for (int pass = 0; pass < 2; ++pass) {
+            std::vector<uint32_t> cursor;
+            if (pass == 1) {
+                for (size_t b = 0; b < num_buckets; ++b) {
+                    bucket_offsets_[b + 1] += bucket_offsets_[b];
+                }
+                bucket_cells_.resize(bucket_offsets_[num_buckets]);
+                cursor.assign(bucket_offsets_.begin(), bucket_offsets_.end() - 1);
+            }
+            for (size_t c = 0; c < cells.size(); ++c) {
+                std::array<size_t, Dim> low = bucket_of(cell_bounds[c].min());
+                std::array<size_t, Dim> high = bucket_of(cell_bounds[c].max());
+                for_each_bucket(low, high, [&](size_t bucket) {
+                    if (pass == 0) {
+                        ++bucket_offsets_[bucket + 1];
+                    } else {
+                        bucket_cells_[cursor[bucket]++] = static_cast<uint32_t>(c);
+                    }
+                });
+            }
+        }
+    }
+
+    size_t num_cells() const { return frames_.size(); }
+
+    /**
+     * @brief Finds the cell containing a point.
+     * @param p The point
+     * @return The index of a cell containing p, or kNotFound
+     */
+    int32_t locate(const Point<T, Dim>& p) const {
+        return locate(p, kNotFound);
+    }
+
+    /**
+     * @brief Locates many points. Each thread handles a contiguous run of the
+     * points and tries the previous point's cell first, which makes sorted or
+     * spatially coherent input cheap.
+     * @param points The points
+     * @param executor Pool and number of threads
+     * @return For each point, the index of a containing cell or kNotFound
+     */
+    std::vector<int32_t> locate(const std::vector<Point<T, Dim>>& points,
+                                Executor executor = Executor()) const {
+        std::vector<int32_t> result(points.size());
+        auto run = [&](size_t begin, size_t end) {
+            int32_t previous = kNotFound;
+            for (size_t i = begin; i < end; ++i) {
+                result[i] = locate(points[i], previous);
+                if (result[i] != kNotFound) previous = result[i];
+            }
+        };
+        for_each_run(points.size(), executor, run);
+        return result;
+    }
+
+    /**
+     * @brief Barycentric coordinates of a point with respect to one cell.
+     */
+    std::array<T, Dim + 1> coordinates(size_t cell, const Point<T, Dim>& p) const {
+        return frames_[cell].coordinates(p);
+    }
+
+private:
+    static constexpr size_t kMaxResolution = 1 << 10;
+
+    std::vector<BarycentricFrame<T, Dim, Dim + 1>> frames_;
+    BoundingBox<T, Dim> bounds_;
+    std::array<size_t, Dim> resolution_{};
+    std::array<T, Dim> inverse_bucket_size_{};
+    std::vector<uint32_t> bucket_offsets_;
+    std::vector<uint32_t> bucket_cells_;
+    T tolerance_;
+
+    int32_t locate(const Point<T, Dim>& p, int32_t hint) const {
+        if (hint != kNotFound && frames_[hint].contains(p, tolerance_)) return hint;
+        if (frames_.empty()) return kNotFound;
+
+        // Points outside the grid clamp to a boundary bucket, whose cells then reject them.
+        size_t bucket = linear_index(bucket_of(p));
+        for (uint32_t i = bucket_offsets_[bucket]; i < bucket_offsets_[bucket + 1]; ++i) {
+            uint32_t cell = bucket_cells_[i];
+            if (frames_[cell].contains(p, tolerance_)) return static_cast<int32_t>(cell);
+        }
+        return kNotFound;
+    }
+
+    std::array<size_t, Dim> bucket_of(const Point<T, Dim>& p) const {
+        std::array<size_t, Dim> bucket;
+        for (size_t i = 0; i < Dim; ++i) {
+            T offset = (p[i] - bounds_.min()[i]) * inverse_bucket_size_[i];
+            bucket[i] = offset <= 0 ? 0 : static_cast<size_t>(std::min<T>(offset, resolution_[i] - 1));
+        }
+        return bucket;
+    }
+
+    size_t linear_index(const std::array<size_t, Dim>& bucket) const {
+        size_t index = 0;
+        for (size_t i = Dim; i-- > 0;) {
+            index = index * resolution_[i] + bucket[i];
+        }
+        return index;
+    }
+
+    // Calls fn(linear index) for every bucket in the box [low, high].
+    template <typename Fn>
+    void for_each_bucket(const std::array<size_t, Dim>& low, const std::array<size_t, Dim>& high, Fn fn) const {
+        std::array<size_t, Dim> bucket = low;
+        while (true) {
+            fn(linear_index(bucket));
+            size_t i = 0;
+            while (i < Dim && bucket[i] == high[i]) {
+                bucket[i] = low[i];
+                ++i;
+            }
+            if (i == Dim) return;
+            ++bucket[i];
+        }
+    }
+};
+
+} // namespace geometry
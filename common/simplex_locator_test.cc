@@ -0,0 +1,86 @@
+#include <iostream>
+#include <random>
+#include "simplex.hh"
+#include "simplex_locator.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Point in a triangle embedded in 3D
+    Simplex<double, 3> triangle({Point<double, 3>(0, 0, 0), Point<double, 3>(1, 0, 0), Point<double, 3>(0, 1, 0)});
+    Point<double, 3> inside(0.25, 0.25, 0);
+    Point<double, 3> above(0.25, 0.25, 1);
+    BarycentricFrame<double, 3, 3> frame = triangle.barycentric_frame();
+    std::array<double, 3> lambda = frame.coordinates(inside);
+    std::cout << "Test 1 - Triangle in 3D:" << std::endl;
+    std::cout << "Barycentric coordinates of " << inside << ": (" << lambda[0] << ", " << lambda[1]
+              << ", " << lambda[2] << ")" << std::endl;
+    std::cout << "Contains " << inside << "? " << (frame.contains(inside) ? "Yes" : "No") << std::endl;
+    std::cout << "Contains " << above << "? " << (frame.contains(above) ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: Tetrahedral mesh of the cube [0, n]^3, six tetrahedra per unit cube
+    const uint32_t n = 10;
+    std::vector<Point<double, 3>> vertices;
+    for (uint32_t z = 0; z <= n; ++z) {
+        for (uint32_t y = 0; y <= n; ++y) {
+            for (uint32_t x = 0; x <= n; ++x) {
+                vertices.emplace_back(x, y, z);
+            }
+        }
+    }
+    auto vertex = [n](uint32_t x, uint32_t y, uint32_t z) { return (z * (n + 1) + y) * (n + 1) + x; };
+    const uint32_t paths[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+    std::vector<SimplexMeshLocator<double, 3>::Cell> cells;
+    for (uint32_t z = 0; z < n; ++z) {
+        for (uint32_t y = 0; y < n; ++y) {
+            for (uint32_t x = 0; x < n; ++x) {
+                for (const auto& path : paths) {
+                    // Walk from corner (x, y, z) to the opposite corner one axis at a time.
+                    uint32_t c[3] = {x, y, z};
+                    SimplexMeshLocator<double, 3>::Cell cell;
+                    cell[0] = vertex(c[0], c[1], c[2]);
+                    for (int step = 0; step < 3; ++step) {
+                        ++c[path[step]];
+                        cell[step + 1] = vertex(c[0], c[1], c[2]);
+                    }
+                    cells.push_back(cell);
+                }
+            }
+        }
+    }
+    SimplexMeshLocator<double, 3> locator(vertices, cells);
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> coordinate(-1.0, n + 1.0);
+    std::vector<Point<double, 3>> points;
+    for (int i = 0; i < 100000; ++i) {
+        points.emplace_back(coordinate(generator), coordinate(generator), coordinate(generator));
+    }
+    std::vector<int32_t> located = locator.locate(points);
+
+    size_t found = 0;
+    bool consistent = true;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Point<double, 3>& p = points[i];
+        bool in_cube = p.x() >= 0 && p.x() <= n && p.y() >= 0 && p.y() <= n && p.z() >= 0 && p.z() <= n;
+        if (located[i] == SimplexMeshLocator<double, 3>::kNotFound) {
+            consistent = consistent && !in_cube;
+            continue;
+        }
+        ++found;
+        std::array<double, 4> weights = locator.coordinates(located[i], p);
+        Point<double, 3> reconstructed;
+        for (size_t k = 0; k < 4; ++k) {
+            reconstructed += vertices[cells[located[i]][k]] * weights[k];
+        }
+        consistent = consistent && in_cube && squared_norm(reconstructed - p) < 1e-18;
+    }
+    std::cout << "Test 2 - Tetrahedral mesh:" << std::endl;
+    std::cout << "Mesh with " << locator.num_cells() << " tetrahedra" << std::endl;
+    std::cout << "Located " << found << " of " << points.size() << " points" << std::endl;
+    std::cout << "Results consistent with the cube and the barycentric coordinates? "
+              << (consistent ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
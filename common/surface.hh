@@ -2,6 +2,11 @@
 
 #pragma once
 
+#include <cmath>
+#include <initializer_list>
+#include <memory_resource>
+#include <vector>
+
 #include "common/simplex.hh"
 
 namespace geometry {
@@ -9,14 +14,21 @@ namespace geometry {
 /**
  * @brief Represents a (K-1)-dimensional manifold in K-dimensional space,
  * composed of a set of (K-1)-simplices (facets).
+ *
+ * The facets are allocated from a memory resource, the default heap unless
+ * one is given, so that a mesh and the indexes built over it can share an
+ * arena and be dropped together.
  */
 template <typename T, size_t K>
 class Surface {
 public:
-    std::vector<Simplex<T, K>> facets;
+    std::pmr::vector<Simplex<T, K>> facets;
 
     Surface() = default;
 
+    // Construct an empty surface whose facets are allocated from resource
+    explicit Surface(std::pmr::memory_resource* resource) : facets(resource) {}
+
     // Construct a surface from an initializer list of simplices
     Surface(std::initializer_list<Simplex<T, K>> facet_list) : facets(facet_list) {}
 
@@ -73,12 +85,7 @@ public:
             
             Point<T, 3> cp = cross_product(ab, ac);
             
-            double magnitude_sq = 0.0;
-            for(size_t i = 0; i < 3; ++i) {
-                magnitude_sq += static_cast<double>(cp[i] * cp[i]);
-            }
-            
-            total_area += 0.5 * std::sqrt(magnitude_sq);
+            total_area += 0.5 * std::sqrt(squared_norm<double>(cp));
         }
         return total_area;
     }
@@ -0,0 +1,47 @@
+// Author: HW
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+
+#include "common/point.hh"
+#include "common/simplex.hh"
+#include "common/surface.hh"
+
+namespace geometry {
+
+/**
+ * @brief Builds a triangulated sphere for tests and benchmarks: a UV sphere
+ * with 2 * stacks * slices facets, the ones at the poles degenerate.
+ * @param center The center of the sphere
+ * @param radius The radius of the sphere
+ * @param stacks Number of bands from pole to pole
+ * @param slices Number of segments around the axis
+ * @param resource Memory resource the facets are allocated from
+ * @return The surface
+ */
+inline Surface<double, 3> triangulated_sphere(const Point<double, 3>& center, double radius, size_t stacks,
+                                              size_t slices,
+                                              std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    const double pi = std::acos(-1.0);
+    auto vertex = [&](size_t i, size_t j) {
+        double theta = pi * i / stacks;
+        double phi = 2 * pi * j / slices;
+        return Point<double, 3>(center.x() + radius * std::sin(theta) * std::cos(phi),
+                                center.y() + radius * std::sin(theta) * std::sin(phi),
+                                center.z() + radius * std::cos(theta));
+    };
+    Surface<double, 3> surface(resource);
+    surface.facets.reserve(2 * stacks * slices);
+    for (size_t i = 0; i < stacks; ++i) {
+        for (size_t j = 0; j < slices; ++j) {
+            surface.add_facet(Simplex<double, 3>({vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1)}));
+            surface.add_facet(Simplex<double, 3>({vertex(i, j), vertex(i + 1, j + 1), vertex(i, j + 1)}));
+        }
+    }
+    return surface;
+}
+
+} // namespace geometry
@@ -0,0 +1,388 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace geometry {
+
+/**
+ * @brief Work-stealing thread pool shared by the batch geometry queries.
+ *
+ * A pool of concurrency N runs N - 1 workers; the thread that submits work is
+ * the N-th and runs tasks until its batch is done. Each worker owns a deque:
+ * it pushes and pops its own tasks at the back and steals the oldest tasks
+ * from the front of the others, trying the workers of its own NUMA node
+ * first. Threads outside the pool spread their tasks over all deques.
+ *
+ * A thread waiting for a batch runs queued tasks while there are any and
+ * otherwise sleeps until the batch finishes or more work is queued, so a task
+ * may itself submit work (nested parallelism) without starting threads
+ * beyond the pool's concurrency or deadlocking.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param concurrency Number of threads running tasks, the submitting one included
+     * @param pin_workers Whether to bind each worker to one CPU, filling one
+     *                    NUMA node after the other (Linux only)
+     */
+    explicit ThreadPool(size_t concurrency = std::thread::hardware_concurrency(), bool pin_workers = false) {
+        concurrency = std::max<size_t>(1, concurrency);
+        const Topology topology = read_topology();
+        const size_t num_workers = concurrency - 1;
+
+        // Slot 0 is the submitting thread's; worker w takes slot w + 1.
+        std::vector<int> node(concurrency, 0);
+        for (size_t slot = 0; slot < concurrency; ++slot) {
+            node[slot] = topology.nodes[slot % topology.cpus.size()];
+        }
+        // The last queue takes the tasks of threads outside the pool.
+        for (size_t q = 0; q <= num_workers; ++q) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t q = 0; q <= num_workers; ++q) {
+            const int own = q < num_workers ? node[q + 1] : node[0];
+            std::vector<uint32_t>& victims = queues_[q]->victims;
+            for (int pass = 0; pass < 2; ++pass) {
+                for (size_t k = 1; k <= num_workers; ++k) {
+                    const size_t other = (q + k) % (num_workers + 1);
+                    if (other == num_workers) continue;
+                    if ((node[other + 1] == own) == (pass == 0)) victims.push_back(static_cast<uint32_t>(other));
+                }
+            }
+            if (q < num_workers) victims.push_back(static_cast<uint32_t>(num_workers));
+        }
+
+        for (size_t w = 0; w < num_workers; ++w) {
+            workers_.emplace_back([this, w] { work(w); });
+            if (pin_workers) pin(workers_.back(), topology.cpus[(w + 1) % topology.cpus.size()]);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        sleep_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief The process-wide pool, one thread per hardware thread.
+     */
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t concurrency() const { return workers_.size() + 1; }
+
+    /**
+     * @brief Calls fn(task) for each task in [0, num_tasks) and returns when
+     * all have finished. The calling thread takes part.
+     * @throws The first exception thrown by a task, after all have finished
+     */
+    template <typename Fn>
+    void run(size_t num_tasks, Fn&& fn) {
+        if (num_tasks == 0) return;
+        using Callable = std::remove_reference_t<Fn>;
+        Job job;
+        job.fn = const_cast<void*>(static_cast<const void*>(&fn));
+        job.invoke = [](void* f, size_t task) { (*static_cast<Callable*>(f))(task); };
+        job.pending.store(num_tasks, std::memory_order_relaxed);
+
+        const size_t self = current_queue();
+        if (self != queues_.size() - 1) {
+            // A worker: keep the tasks local, others steal them.
+            std::lock_guard<std::mutex> lock(queues_[self]->mutex);
+            for (size_t task = num_tasks; task-- > 0;) {
+                queues_[self]->tasks.push_back(Task{&job, task});
+            }
+        } else {
+            for (size_t q = 0; q < queues_.size(); ++q) {
+                std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+                for (size_t task = q; task < num_tasks; task += queues_.size()) {
+                    queues_[q]->tasks.push_back(Task{&job, task});
+                }
+            }
+        }
+        queued_.fetch_add(num_tasks, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        if (num_tasks > 1) sleep_.notify_all();
+        else sleep_.notify_one();
+
+        // Help until the batch is done, sleeping while there is nothing to run.
+        Task task;
+        while (job.pending.load(std::memory_order_acquire) > 0) {
+            if (pop(self, task)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleep_.wait(lock, [&] {
+                return job.pending.load(std::memory_order_acquire) == 0 ||
+                       queued_.load(std::memory_order_acquire) > 0;
+            });
+        }
+        if (job.error) std::rethrow_exception(job.error);
+    }
+
+    /**
+     * @brief Calls fn(begin, end) on chunks of [0, n) of at most grain indices.
+     * @param grain Chunk size; 0 picks about four chunks per thread
+     */
+    template <typename Fn>
+    void parallel_for(size_t n, size_t grain, Fn&& fn) {
+        if (n == 0) return;
+        if (grain == 0) grain = std::max<size_t>(1, n / (4 * concurrency()));
+        const size_t num_chunks = (n + grain - 1) / grain;
+        if (num_chunks == 1) {
+            fn(size_t{0}, n);
+            return;
+        }
+        run(num_chunks, [&](size_t chunk) { fn(chunk * grain, std::min(n, (chunk + 1) * grain)); });
+    }
+
+    /**
+     * @brief Maps chunks of [0, n) to values with map(begin, end) and folds
+     * them with combine, in chunk order, so the result does not depend on
+     * scheduling.
+     * @param grain Chunk size; 0 picks about four chunks per thread
+     * @param identity Value for an empty range
+     */
+    template <typename R, typename Map, typename Combine>
+    R parallel_reduce(size_t n, size_t grain, R identity, Map&& map, Combine&& combine) {
+        if (n == 0) return identity;
+        if (grain == 0) grain = std::max<size_t>(1, n / (4 * concurrency()));
+        const size_t num_chunks = (n + grain - 1) / grain;
+        std::vector<R> partial(num_chunks, identity);
+        run(num_chunks, [&](size_t chunk) { partial[chunk] = map(chunk * grain, std::min(n, (chunk + 1) * grain)); });
+        R result = std::move(identity);
+        for (R& value : partial) {
+            result = combine(std::move(result), std::move(value));
+        }
+        return result;
+    }
+
+private:
+    struct Job {
+        void (*invoke)(void*, size_t);
+        void* fn;
+        std::atomic<size_t> pending{0};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    struct Task {
+        Job* job = nullptr;
+        size_t index = 0;
+    };
+
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        // Queues to steal from, own NUMA node first.
+        std::vector<uint32_t> victims;
+    };
+
+    // Allowed CPUs ordered by NUMA node, and the node of each.
+    struct Topology {
+        std::vector<int> cpus;
+        std::vector<int> nodes;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_;
+    bool stopping_ = false;
+
+    // Identifies the worker a thread is, if any.
+    struct Identity {
+        const ThreadPool* pool = nullptr;
+        size_t queue = 0;
+    };
+
+    static Identity& identity() {
+        static thread_local Identity id;
+        return id;
+    }
+
+    size_t current_queue() const {
+        const Identity& id = identity();
+        return id.pool == this ? id.queue : queues_.size() - 1;
+    }
+
+    void work(size_t w) {
+        identity() = Identity{this, w};
+        Task task;
+        while (true) {
+            if (pop(w, task)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleep_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+            if (stopping_ && queued_.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+    // Takes the newest task of the own queue, or steals the oldest of another.
+    bool pop(size_t q, Task& task) {
+        if (queued_.load(std::memory_order_acquire) == 0) return false;
+        {
+            Queue& own = *queues_[q];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (uint32_t v : queues_[q]->victims) {
+            Queue& victim = *queues_[v];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs a task and wakes the threads waiting for its batch if it was the
+    // last one. The job may be gone once pending reaches zero.
+    void execute(const Task& task) {
+        Job& job = *task.job;
+        try {
+            job.invoke(job.fn, task.index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.error_mutex);
+            if (!job.error) job.error = std::current_exception();
+        }
+        if (job.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+            }
+            sleep_.notify_all();
+        }
+    }
+
+    // Parses a sysfs CPU list such as "0-3,8-11".
+    static std::vector<int> parse_cpu_list(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            if (range.empty() || range == "\n") continue;
+            const size_t dash = range.find('-');
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    static Topology read_topology() {
+        Topology topology;
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            std::vector<int> node_of(CPU_SETSIZE, 0);
+            for (int node = 0;; ++node) {
+                std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                std::string list;
+                if (!file || !std::getline(file, list)) break;
+                for (int cpu : parse_cpu_list(list)) {
+                    if (cpu >= 0 && cpu < CPU_SETSIZE) node_of[cpu] = node;
+                }
+            }
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) topology.cpus.push_back(cpu);
+            }
+            std::stable_sort(topology.cpus.begin(), topology.cpus.end(),
+                             [&](int a, int b) { return node_of[a] < node_of[b]; });
+            for (int cpu : topology.cpus) {
+                topology.nodes.push_back(node_of[cpu]);
+            }
+        }
+#endif
+        if (topology.cpus.empty()) {
+            topology.cpus.push_back(0);
+            topology.nodes.push_back(0);
+        }
+        return topology;
+    }
+
+    static void pin(std::thread& thread, int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)cpu;
+#endif
+    }
+};
+
+/**
+ * @brief Where a batch query runs: a pool, and the number of parallel runs
+ * it splits its work into. Converts from a thread count, which selects the
+ * shared pool, so callers that pass a count keep working.
+ */
+class Executor {
+public:
+    Executor(size_t num_threads = std::thread::hardware_concurrency())
+        : pool_(&ThreadPool::shared()), num_threads_(std::max<size_t>(1, num_threads)) {}
+
+    Executor(ThreadPool& pool): pool_(&pool), num_threads_(pool.concurrency()) {}
+
+    Executor(ThreadPool& pool, size_t num_threads): pool_(&pool), num_threads_(std::max<size_t>(1, num_threads)) {}
+
+    ThreadPool& pool() const { return *pool_; }
+
+    size_t num_threads() const { return num_threads_; }
+
+private:
+    ThreadPool* pool_;
+    size_t num_threads_;
+};
+
+} // namespace geometry
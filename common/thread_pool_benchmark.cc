@@ -0,0 +1,90 @@
+// Times batch queries on the shared thread pool for 1, 2, 4, ... threads and
+// the pool's concurrency, and reports speedup and parallel efficiency
+// (speedup / threads) for each kernel: k-d tree k-nearest neighbours, point
+// in polygon, segment against voxelized surface, and 2D convex hull.
+//
+// Usage: thread_pool_benchmark [queries per kernel, default 2000000]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark_timing.hh"
+#include "convex_hull.hh"
+#include "kd_tree.hh"
+#include "polygon.hh"
+#include "test_meshes.hh"
+#include "thread_pool.hh"
+#include "voxel_grid.hh"
+
+namespace {
+
+// Runs a kernel for each thread count and prints its scaling.
+void measure(const std::string& name, const std::function<void(size_t)>& kernel) {
+    std::cout << name << ":" << std::endl;
+    double baseline = 0;
+    geometry::for_each_thread_count(geometry::ThreadPool::shared().concurrency(), [&](size_t threads) {
+        auto start = std::chrono::steady_clock::now();
+        kernel(threads);
+        double elapsed = geometry::seconds_since(start);
+        if (threads == 1) baseline = elapsed;
+        double speedup = baseline / elapsed;
+        std::cout << "  " << threads << " threads: " << elapsed << " s, speedup " << speedup << ", efficiency "
+                  << speedup / threads << std::endl;
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    using namespace geometry;
+
+    const size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    std::mt19937 rng(38);
+    std::uniform_real_distribution<double> coordinate(-1, 1);
+    std::cout << "Shared pool concurrency: " << ThreadPool::shared().concurrency() << std::endl;
+
+    std::vector<Point<double, 3>> points3(n);
+    for (auto& p : points3) {
+        p = Point<double, 3>(coordinate(rng), coordinate(rng), coordinate(rng));
+    }
+    KdTree<double, 3> tree(points3);
+    std::vector<Point<double, 3>> queries3(n);
+    for (auto& q : queries3) {
+        q = Point<double, 3>(coordinate(rng), coordinate(rng), coordinate(rng));
+    }
+    measure("k-d tree, 8 nearest neighbours", [&](size_t threads) { tree.nearest(queries3, 8, threads); });
+
+    const double pi = std::acos(-1.0);
+    std::uniform_real_distribution<double> radius(0.3, 1.0);
+    std::vector<Point<double, 2>> ring;
+    for (int i = 0; i < 1000; ++i) {
+        double angle = 2 * pi * i / 1000;
+        double r = radius(rng);
+        ring.emplace_back(r * std::cos(angle), r * std::sin(angle));
+    }
+    Polygon<double> star(ring);
+    std::vector<Point<double, 2>> points2(n);
+    for (auto& p : points2) {
+        p = Point<double, 2>(coordinate(rng), coordinate(rng));
+    }
+    measure("Point in polygon, 1000 edges", [&](size_t threads) { star.contains(points2, threads); });
+
+    Surface<double, 3> ball = triangulated_sphere(Point<double, 3>(0, 0, 0), 0.8, 300, 600);
+    VoxelGrid<double> grid(ball, 0.01);
+    std::vector<LineSegment<double, 3>> segments(n);
+    for (auto& s : segments) {
+        Point<double, 3> start(coordinate(rng), coordinate(rng), coordinate(rng));
+        Point<double, 3> step(coordinate(rng), coordinate(rng), coordinate(rng));
+        s = LineSegment<double, 3>(start, start + step * 0.1);
+    }
+    measure("Segment against voxelized sphere", [&](size_t threads) { grid.do_intersect(segments, threads); });
+
+    measure("2D convex hull", [&](size_t threads) { convex_hull(points2, threads); });
+    return 0;
+}
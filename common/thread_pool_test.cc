@@ -0,0 +1,99 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "kd_tree.hh"
+#include "thread_pool.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: parallel_for visits every index once
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(100000);
+    pool.parallel_for(visits.size(), 1000, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            visits[i].fetch_add(1);
+        }
+    });
+    bool once = true;
+    for (const auto& count : visits) {
+        once = once && count.load() == 1;
+    }
+    std::cout << "Test 1 - parallel_for:" << std::endl;
+    std::cout << "Concurrency: " << pool.concurrency() << std::endl;
+    std::cout << "Every index visited once? " << (once ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: parallel_reduce against a serial sum
+    std::vector<uint64_t> values(1000000);
+    std::iota(values.begin(), values.end(), 1);
+    uint64_t sum = pool.parallel_reduce(
+            values.size(), 0, uint64_t{0},
+            [&](size_t begin, size_t end) {
+                return std::accumulate(values.begin() + begin, values.begin() + end, uint64_t{0});
+            },
+            [](uint64_t a, uint64_t b) { return a + b; });
+    std::cout << "Test 2 - parallel_reduce:" << std::endl;
+    std::cout << "Sum: " << sum << std::endl;
+    uint64_t serial = std::accumulate(values.begin(), values.end(), uint64_t{0});
+    std::cout << "Matches serial sum? " << (sum == serial ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: Nested loops on a pool of two threads
+    ThreadPool small(2);
+    std::atomic<uint64_t> nested{0};
+    small.parallel_for(64, 1, [&](size_t outer, size_t) {
+        small.parallel_for(1000, 10, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                nested.fetch_add(outer * 1000 + i);
+            }
+        });
+    });
+    std::cout << "Test 3 - Nested parallel_for:" << std::endl;
+    std::cout << "Sum: " << nested.load() << std::endl;
+    std::cout << "Matches serial sum? " << (nested.load() == uint64_t{64000} * 63999 / 2 ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 4: An exception thrown by a task reaches the caller
+    bool caught = false;
+    try {
+        pool.run(16, [](size_t task) {
+            if (task == 7) throw std::runtime_error("task 7 failed");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    std::cout << "Test 4 - Exceptions:" << std::endl;
+    std::cout << "Caught? " << (caught ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 5: A tree built and queried on a private pool, with nested
+    // tasks in the build, against the shared pool
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> coordinate(0, 1);
+    std::vector<Point<double, 3>> points(300000), queries(5000);
+    for (auto& p : points) {
+        p = Point<double, 3>(coordinate(rng), coordinate(rng), coordinate(rng));
+    }
+    for (auto& q : queries) {
+        q = Point<double, 3>(coordinate(rng), coordinate(rng), coordinate(rng));
+    }
+    KdTree<double, 3> shared_tree(points);
+    KdTree<double, 3> private_tree(points, Executor(small, 8));
+    auto expected = shared_tree.nearest(queries, 4);
+    auto found = private_tree.nearest(queries, 4, Executor(small));
+    bool same = true;
+    for (size_t q = 0; q < queries.size(); ++q) {
+        for (size_t k = 0; k < 4; ++k) {
+            same = same && found[q][k].squared_distance == expected[q][k].squared_distance;
+        }
+    }
+    std::cout << "Test 5 - k-d tree on a private pool:" << std::endl;
+    std::cout << "Matches the shared pool? " << (same ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,288 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "common/dynamic_aabb_tree.hh"
+#include "common/line_segment.hh"
+#include "common/line_segment_intersection.hh"
+#include "common/line_segment_plane_intersection.hh"
+#include "common/parallel_runs.hh"
+#include "common/plane.hh"
+#include "common/point.hh"
+
+namespace geometry {
+
+// The functions below sweep a segment translated by a displacement over one
+// time step, t in [0, 1], and return the first time of contact with an
+// obstacle, or infinity if there is none within the step. A segment touching
+// the obstacle at t = 0 has time 0.
+
+// Relative size of the cross product of ray and segment below which they
+// are treated as parallel.
+constexpr double kParallelThreshold = 1e-12;
+
+/**
+ * @brief Earliest impact of one moving segment in a batch query.
+ */
+template <typename T>
+struct Impact {
+    // Index of the obstacle hit first, or -1 if none is hit.
+    int32_t target = -1;
+    T time = std::numeric_limits<T>::infinity();
+};
+
+/**
+ * @brief Calculates when a translating segment first touches a plane.
+ * Both endpoints approach the plane at the same rate, so the endpoint nearer
+ * to it arrives first.
+ * @param segment The segment at t = 0
+ * @param displacement The segment's motion over the step
+ * @param plane The plane
+ * @param tolerance Distance at which the segment touches the plane
+ * @return The time of contact in [0, 1], or infinity
+ */
+template <typename T>
+T time_of_impact(const LineSegment<T, 3>& segment, const Point<T, 3>& displacement, const Plane<T>& plane,
+                 T tolerance = 1e-9) {
+    if (do_intersect(segment, plane, tolerance)) return 0;
+
+    // Both endpoints are on the same side, farther than tolerance.
+    T d1 = plane.distance_to_point(segment.start());
+    T d2 = plane.distance_to_point(segment.end());
+    T gap = std::min(std::abs(d1), std::abs(d2)) - tolerance;
+    T rate = dot_product(plane.normal(), displacement);
+    // Speed towards the plane.
+    T approach = d1 > 0 ? -rate : rate;
+    if (!(approach > 0) || gap > approach) return std::numeric_limits<T>::infinity();
+    return gap / approach;
+}
+
+/**
+ * @brief Calculates when a point moving along a ray first touches a segment.
+ * @param origin The point at t = 0
+ * @param direction The point's motion over the step
+ * @param segment The segment
+ * @param tolerance Distance at which a parallel ray touches the segment
+ * @return The time of contact in [0, 1], or infinity
+ */
+template <typename T>
+T ray_cast(const Point<T, 2>& origin, const Point<T, 2>& direction, const LineSegment<T, 2>& segment,
+           T tolerance = 1e-9) {
+    auto perp_dot = [](const Point<T, 2>& a, const Point<T, 2>& b) { return a.x() * b.y() - a.y() * b.x(); };
+    const T no_impact = std::numeric_limits<T>::infinity();
+    Point<T, 2> edge = segment.end() - segment.start();
+    Point<T, 2> offset = segment.start() - origin;
+    T denominator = perp_dot(direction, edge);
+
+    // origin + t direction = start + s edge
+    if (std::abs(denominator) > kParallelThreshold * norm(direction) * norm(edge)) {
+        T t = perp_dot(offset, edge) / denominator;
+        T s = perp_dot(offset, direction) / denominator;
+        if (t < 0 || t > 1 || s < 0 || s > 1) return no_impact;
+        return t;
+    }
+
+    // Parallel: only a ray along the segment's line can touch it.
+    T squared_length = dot_product(direction, direction);
+    if (squared_length == 0) return no_impact;
+    if (std::abs(perp_dot(offset, direction)) > tolerance * std::sqrt(squared_length)) return no_impact;
+    T t1 = dot_product(offset, direction) / squared_length;
+    T t2 = dot_product(segment.end() - origin, direction) / squared_length;
+    if (t1 > t2) std::swap(t1, t2);
+    if (t2 < 0 || t1 > 1) return no_impact;
+    return std::max<T>(t1, 0);
+}
+
+/**
+ * @brief Calculates when a translating 2D segment first touches a static one.
+ * The set of displacements at which the segments touch is a parallelogram,
+ * so first contact is exact and is found by four ray casts: each endpoint of
+ * the moving segment against the static one, and each endpoint of the static
+ * segment, moving backwards, against the moving one.
+ * @param segment The moving segment at t = 0
+ * @param displacement The segment's motion over the step
+ * @param obstacle The static segment
+ * @param tolerance Distance at which parallel segments touch
+ * @return The time of contact in [0, 1], or infinity
+ */
+template <typename T>
+T time_of_impact(const LineSegment<T, 2>& segment, const Point<T, 2>& displacement,
+                 const LineSegment<T, 2>& obstacle, T tolerance = 1e-9) {
+    if (do_intersect(segment, obstacle)) return 0;
+    Point<T, 2> backwards = displacement * T(-1);
+    return std::min({ray_cast(segment.start(), displacement, obstacle, tolerance),
+                     ray_cast(segment.end(), displacement, obstacle, tolerance),
+                     ray_cast(obstacle.start(), backwards, segment, tolerance),
+                     ray_cast(obstacle.end(), backwards, segment, tolerance)});
+}
+
+/**
+ * @brief Finds, for many translating segments, the plane each touches first.
+ *
+ * The broadphase groups parallel planes, with opposite normals counted as
+ * parallel, and sorts each group by offset along the shared normal. A
+ * segment sweeps an interval of offsets along each normal, spanned by its
+ * four corner points; only the planes of a group within that interval,
+ * widened by tolerance and a rounding margin, get the exact test. A query
+ * therefore costs O(groups * log(planes)) plus the candidates: planes that
+ * are all pairwise non-parallel gain nothing over testing each of them.
+ *
+ * @param segments The segments at t = 0
+ * @param displacements The motion of each segment over the step
+ * @param planes The planes
+ * @param executor Pool and number of threads
+ * @param tolerance Distance at which a segment touches a plane
+ * @return For each segment, the index of the first plane it touches (the
+ *         lowest index on ties) and the time
+ * @throws std::invalid_argument if there is not one displacement per segment
+ */
+template <typename T>
+std::vector<Impact<T>> earliest_impacts(const std::vector<LineSegment<T, 3>>& segments,
+                                        const std::vector<Point<T, 3>>& displacements,
+                                        const std::vector<Plane<T>>& planes,
+                                        Executor executor = Executor(),
+                                        T tolerance = 1e-9) {
+    if (segments.size() != displacements.size()) {
+        throw std::invalid_argument("Need one displacement per segment");
+    }
+    std::vector<Impact<T>> result(segments.size());
+
+    // Planes sharing a normal, up to sign, sorted by offset along it.
+    struct ParallelPlanes {
+        Point<T, 3> normal;
+        T magnitude = 0;  // Largest coordinate magnitude of the plane points
+        std::vector<std::pair<T, int32_t>> offsets;
+    };
+    auto canonical = [](const Point<T, 3>& normal) -> Point<T, 3> {
+        for (size_t i = 0; i < 3; ++i) {
+            if (normal[i] != 0) return normal[i] < 0 ? Point<T, 3>(normal * T(-1)) : normal;
+        }
+        return normal;
+    };
+    auto before = [](const Point<T, 3>& a, const Point<T, 3>& b) {
+        return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+    };
+    std::vector<Point<T, 3>> normals(planes.size());
+    std::vector<int32_t> order(planes.size());
+    for (size_t p = 0; p < planes.size(); ++p) {
+        normals[p] = canonical(planes[p].normal());
+        order[p] = static_cast<int32_t>(p);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int32_t a, int32_t b) { return before(normals[a], normals[b]); });
+    std::vector<ParallelPlanes> groups;
+    for (int32_t p : order) {
+        if (groups.empty() || before(groups.back().normal, normals[p])) {
+            groups.push_back(ParallelPlanes{normals[p], T(0), {}});
+        }
+        ParallelPlanes& group = groups.back();
+        for (size_t i = 0; i < 3; ++i) {
+            group.magnitude = std::max(group.magnitude, std::abs(planes[p].point()[i]));
+        }
+        group.offsets.emplace_back(dot_product(group.normal, planes[p].point()), p);
+    }
+    for (ParallelPlanes& group : groups) {
+        std::sort(group.offsets.begin(), group.offsets.end());
+    }
+
+    for_each_run(segments.size(), executor, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const LineSegment<T, 3>& segment = segments[i];
+            T magnitude = 0;
+            for (size_t k = 0; k < 3; ++k) {
+                magnitude = std::max({magnitude, std::abs(segment.start()[k]), std::abs(segment.end()[k])});
+            }
+            magnitude += std::max({std::abs(displacements[i][0]), std::abs(displacements[i][1]),
+                                   std::abs(displacements[i][2])});
+            for (const ParallelPlanes& group : groups) {
+                const T s = dot_product(group.normal, segment.start());
+                const T e = dot_product(group.normal, segment.end());
+                const T d = dot_product(group.normal, displacements[i]);
+                // The offsets computed here and the distances in the exact
+                // test round differently; the margin covers both.
+                const T margin = tolerance + 64 * std::numeric_limits<T>::epsilon() * (magnitude + group.magnitude);
+                const T low = std::min(s, e) + std::min(d, T(0)) - margin;
+                const T high = std::max(s, e) + std::max(d, T(0)) + margin;
+                auto first = std::lower_bound(group.offsets.begin(), group.offsets.end(),
+                                              std::make_pair(low, std::numeric_limits<int32_t>::min()));
+                for (auto it = first; it != group.offsets.end() && !(it->first > high); ++it) {
+                    const int32_t p = it->second;
+                    T time = time_of_impact(segment, displacements[i], planes[p], tolerance);
+                    Impact<T>& impact = result[i];
+                    if (time < impact.time || (time == impact.time && time <= 1 && p < impact.target)) {
+                        impact = Impact<T>{p, time};
+                    }
+                }
+            }
+        }
+    });
+    return result;
+}
+
+/**
+ * @brief Finds, for many translating 2D segments, the static segment each
+ * touches first.
+ *
+ * The broadphase puts the swept box of every moving segment and the box of
+ * every obstacle into two dynamic AABB trees and pairs them in one
+ * simultaneous traversal; only overlapping pairs get the exact test.
+ *
+ * @param segments The moving segments at t = 0
+ * @param displacements The motion of each segment over the step
+ * @param obstacles The static segments
+ * @param executor Pool and number of threads
+ * @param tolerance Distance at which parallel segments touch
+ * @return For each moving segment, the index of the first obstacle it touches
+ *         (the lowest index on ties) and the time
+ * @throws std::invalid_argument if there is not one displacement per segment
+ */
+template <typename T>
+std::vector<Impact<T>> earliest_impacts(const std::vector<LineSegment<T, 2>>& segments,
+                                        const std::vector<Point<T, 2>>& displacements,
+                                        const std::vector<LineSegment<T, 2>>& obstacles,
+                                        Executor executor = Executor(),
+                                        T tolerance = 1e-9) {
+    if (segments.size() != displacements.size()) {
+        throw std::invalid_argument("Need one displacement per segment");
+    }
+    std::vector<Impact<T>> result(segments.size());
+
+    // Leaves are never fattened beyond tolerance, so every overlapping pair
+    // is a real candidate. Proxy ids are node indices; map them back.
+    DynamicAabbTree<T, 2> swept(tolerance, 1), fixed(tolerance, 1);
+    std::vector<int32_t> segment_of(2 * segments.size()), obstacle_of(2 * obstacles.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        segment_of[swept.insert(segments[i], displacements[i])] = static_cast<int32_t>(i);
+    }
+    for (size_t i = 0; i < obstacles.size(); ++i) {
+        obstacle_of[fixed.insert(obstacles[i])] = static_cast<int32_t>(i);
+    }
+    std::vector<std::pair<int32_t, int32_t>> pairs = swept.overlapping_pairs(fixed, executor);
+
+    std::vector<T> times(pairs.size());
+    for_each_run(pairs.size(), executor, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            int32_t i = segment_of[pairs[k].first];
+            times[k] = time_of_impact(segments[i], displacements[i], obstacles[obstacle_of[pairs[k].second]],
+                                      tolerance);
+        }
+    });
+
+    for (size_t k = 0; k < pairs.size(); ++k) {
+        Impact<T>& impact = result[segment_of[pairs[k].first]];
+        int32_t target = obstacle_of[pairs[k].second];
+        if (times[k] < impact.time || (times[k] == impact.time && times[k] <= 1 && target < impact.target)) {
+            impact = Impact<T>{target, times[k]};
+        }
+    }
+    return result;
+}
+
+} // namespace geometry
@@ -0,0 +1,101 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "time_of_impact.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Segment moving towards a plane
+    Plane<double> floor(Point<double, 3>(0, 0, 0), Point<double, 3>(0, 0, 1));
+    LineSegment<double, 3> falling(Point<double, 3>(0, 0, 2), Point<double, 3>(1, 0, 3));
+    std::cout << "Test 1 - Segment/plane:" << std::endl;
+    std::cout << "Falling 4 units: t = " << time_of_impact(falling, Point<double, 3>(0, 0, -4), floor) << std::endl;
+    std::cout << "Falling 1 unit: t = " << time_of_impact(falling, Point<double, 3>(0, 0, -1), floor) << std::endl;
+    std::cout << "Rising: t = " << time_of_impact(falling, Point<double, 3>(0, 0, 4), floor) << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: Segment moving past another
+    LineSegment<double, 2> wall(Point<double, 2>(2, -1), Point<double, 2>(2, 1));
+    LineSegment<double, 2> bullet(Point<double, 2>(0, 0), Point<double, 2>(0.5, 0));
+    LineSegment<double, 2> sweeping(Point<double, 2>(1, 3), Point<double, 2>(3, 3));
+    std::cout << "Test 2 - Segment/segment:" << std::endl;
+    std::cout << "Tunnelling bullet: t = " << time_of_impact(bullet, Point<double, 2>(10, 0), wall) << std::endl;
+    std::cout << "Slow bullet: t = " << time_of_impact(bullet, Point<double, 2>(1, 0), wall) << std::endl;
+    std::cout << "Segment swept onto the wall's end: t = " << time_of_impact(sweeping, Point<double, 2>(0, -4), wall) << std::endl;
+    std::cout << std::endl;
+
+    // Test case 3: Batch queries against brute force
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> coordinate(0, 50);
+    std::uniform_real_distribution<double> offset(-1, 1);
+    std::vector<LineSegment<double, 2>> segments, obstacles;
+    std::vector<Point<double, 2>> displacements;
+    for (int i = 0; i < 2000; ++i) {
+        Point<double, 2> start(coordinate(rng), coordinate(rng));
+        segments.emplace_back(start, start + Point<double, 2>(offset(rng), offset(rng)));
+        displacements.push_back(Point<double, 2>(offset(rng), offset(rng)) * 3);
+        Point<double, 2> origin(coordinate(rng), coordinate(rng));
+        obstacles.emplace_back(origin, origin + Point<double, 2>(offset(rng), offset(rng)) * 2);
+    }
+    std::vector<Impact<double>> impacts = earliest_impacts(segments, displacements, obstacles, 4);
+    size_t num_impacts = 0, mismatches = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        Impact<double> expected;
+        for (size_t j = 0; j < obstacles.size(); ++j) {
+            double time = time_of_impact(segments[i], displacements[i], obstacles[j]);
+            if (time < expected.time) expected = Impact<double>{static_cast<int32_t>(j), time};
+        }
+        if (impacts[i].target != expected.target || !(impacts[i].time == expected.time || expected.target < 0)) ++mismatches;
+        num_impacts += expected.target >= 0;
+    }
+    std::cout << "Test 3 - Batch:" << std::endl;
+    std::cout << "Segments hitting an obstacle: " << num_impacts << " of " << segments.size() << std::endl;
+    std::cout << "Matches brute force? " << (mismatches == 0 ? "Yes" : "No") << std::endl;
+
+    std::vector<LineSegment<double, 3>> segments3;
+    std::vector<Point<double, 3>> displacements3;
+    for (int i = 0; i < 1000; ++i) {
+        Point<double, 3> start(offset(rng), offset(rng), offset(rng));
+        segments3.emplace_back(start, start + Point<double, 3>(offset(rng), offset(rng), offset(rng)) * 0.1);
+        displacements3.push_back(Point<double, 3>(offset(rng), offset(rng), offset(rng)));
+    }
+    std::vector<Plane<double>> walls = {Plane<double>(Point<double, 3>(0.5, 0, 0), Point<double, 3>(-1, 0, 0)),
+                                        Plane<double>(Point<double, 3>(-0.5, 0, 0), Point<double, 3>(1, 0, 0)),
+                                        Plane<double>(Point<double, 3>(0, 0, 0.5), Point<double, 3>(0, 0, -1))};
+    std::vector<Impact<double>> plane_impacts = earliest_impacts(segments3, displacements3, walls, 4);
+    size_t plane_mismatches = 0;
+    for (size_t i = 0; i < segments3.size(); ++i) {
+        double best = std::numeric_limits<double>::infinity();
+        for (const Plane<double>& wall : walls) {
+            best = std::min(best, time_of_impact(segments3[i], displacements3[i], wall));
+        }
+        if (!(plane_impacts[i].time == best)) ++plane_mismatches;
+    }
+    std::cout << "Plane batch matches brute force? " << (plane_mismatches == 0 ? "Yes" : "No") << std::endl;
+
+    // Many parallel planes, some facing the other way, and a few tilted ones:
+    // the broadphase tests only the planes within reach of each segment
+    std::vector<Plane<double>> layers;
+    for (int k = 0; k < 200; ++k) {
+        layers.emplace_back(Point<double, 3>(0, 0, -1 + 0.01 * k), Point<double, 3>(0, 0, k % 2 ? 1 : -1));
+        if (k % 50 == 0) {
+            layers.emplace_back(Point<double, 3>(0.02 * k, 0, 0), Point<double, 3>(1, 1, 0));
+        }
+    }
+    std::vector<Impact<double>> layer_impacts = earliest_impacts(segments3, displacements3, layers, 4);
+    size_t layer_mismatches = 0;
+    for (size_t i = 0; i < segments3.size(); ++i) {
+        Impact<double> expected;
+        for (size_t p = 0; p < layers.size(); ++p) {
+            double time = time_of_impact(segments3[i], displacements3[i], layers[p]);
+            if (time < expected.time) expected = Impact<double>{static_cast<int32_t>(p), time};
+        }
+        if (layer_impacts[i].target != expected.target || !(layer_impacts[i].time == expected.time || expected.target < 0)) {
+            ++layer_mismatches;
+        }
+    }
+    std::cout << "Parallel planes match brute force? " << (layer_mismatches == 0 ? "Yes" : "No") << std::endl;
+
+    return 0;
+}
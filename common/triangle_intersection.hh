@@ -0,0 +1,203 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "common/line_segment.hh"
+#include "common/line_segment_intersection.hh"
+#include "common/point.hh"
+#include "common/simplex.hh"
+
+namespace geometry {
+
+/**
+ * @brief Projects a triangle's vertices onto the line of intersection of two
+ * planes and returns the interval it covers there.
+ * @param p Projections of the three vertices onto the line
+ * @param d Signed distances of the three vertices to the other plane (not all on one side)
+ * @return The interval, sorted
+ */
+template <typename T>
+std::pair<T, T> triangle_interval(const T (&p)[3], const T (&d)[3]) {
+    // Find the vertex that is alone on its side of the plane (or on it).
+    size_t alone;
+    if (d[0] * d[1] > 0) alone = 2;
+    else if (d[0] * d[2] > 0) alone = 1;
+    else if (d[1] * d[2] > 0 || d[0] != 0) alone = 0;
+    else if (d[1] != 0) alone = 1;
+    else alone = 2;
+
+    size_t u = (alone + 1) % 3;
+    size_t v = (alone + 2) % 3;
+    // Where the edges (alone, u) and (alone, v) cross the plane. An edge lying
+    // in the plane contributes its far endpoint.
+    T t0 = (d[alone] == d[u]) ? p[u] : p[alone] + (p[u] - p[alone]) * d[alone] / (d[alone] - d[u]);
+    T t1 = (d[alone] == d[v]) ? p[v] : p[alone] + (p[v] - p[alone]) * d[alone] / (d[alone] - d[v]);
+    return std::minmax(t0, t1);
+}
+
+/**
+ * @brief Index of the coordinate axis along which a vector is longest.
+ */
+template <typename T>
+size_t dominant_axis(const Point<T, 3>& v) {
+    size_t axis = 0;
+    for (size_t i = 1; i < 3; ++i) {
+        if (std::abs(v[i]) > std::abs(v[axis])) axis = i;
+    }
+    return axis;
+}
+
+/**
+ * @brief Checks if a point lies in a 2D triangle of either winding (boundary included).
+ */
+template <typename T>
+bool triangle_contains(const Point<T, 2> (&triangle)[3], const Point<T, 2>& p) {
+    int o1 = orientation(triangle[0], triangle[1], p);
+    int o2 = orientation(triangle[1], triangle[2], p);
+    int o3 = orientation(triangle[2], triangle[0], p);
+    bool has_ccw = o1 == 1 || o2 == 1 || o3 == 1;
+    bool has_cw = o1 == 2 || o2 == 2 || o3 == 2;
+    return !(has_ccw && has_cw);
+}
+
+/**
+ * @brief Checks if two coplanar triangles intersect, in the 2D projection
+ * that drops the dominant axis of their normal.
+ * @param a First triangle
+ * @param b Second triangle
+ * @param normal The common normal
+ * @return true if the triangles intersect
+ */
+template <typename T>
+bool coplanar_triangles_intersect(const Simplex<T, 3>& a, const Simplex<T, 3>& b, const Point<T, 3>& normal) {
+    const size_t drop = dominant_axis(normal);
+    const size_t u = (drop + 1) % 3;
+    const size_t v = (drop + 2) % 3;
+    auto project = [u, v](const Point<T, 3>& p) { return Point<T, 2>(p[u], p[v]); };
+
+    Point<T, 2> pa[3], pb[3];
+    for (size_t i = 0; i < 3; ++i) {
+        pa[i] = project(a.vertices[i]);
+        pb[i] = project(b.vertices[i]);
+    }
+
+    // Any pair of crossing edges.
+    for (size_t i = 0; i < 3; ++i) {
+        LineSegment<T, 2> edge_a(pa[i], pa[(i + 1) % 3]);
+        for (size_t j = 0; j < 3; ++j) {
+            if (do_intersect(edge_a, LineSegment<T, 2>(pb[j], pb[(j + 1) % 3]))) return true;
+        }
+    }
+
+    // Otherwise one triangle is inside the other or they are disjoint.
+    return triangle_contains(pa, pb[0]) || triangle_contains(pb, pa[0]);
+}
+
+/**
+ * @brief Determines if two triangles in 3D space intersect (touching counts).
+ * Uses Moller's interval overlap test: each triangle must straddle the
+ * other's plane, and the intervals both cut on the planes' common line must
+ * overlap. Coplanar triangles are tested in 2D.
+ * @param a First triangle
+ * @param b Second triangle
+ * @param tolerance Distance below which a vertex is considered on a plane
+ * @return true if the triangles intersect, false otherwise
+ */
+template <typename T>
+bool do_intersect(const Simplex<T, 3>& a, const Simplex<T, 3>& b, T tolerance = 1e-9) {
+    // Plane of b against the vertices of a.
+    Point<T, 3> nb = cross_product(b.vertices[1] - b.vertices[0], b.vertices[2] - b.vertices[0]);
+    T eps_b = tolerance * norm(nb);
+    T da[3];
+    for (size_t i = 0; i < 3; ++i) {
+        da[i] = dot_product(nb, a.vertices[i] - b.vertices[0]);
+        if (std::abs(da[i]) <= eps_b) da[i] = 0;
+    }
+    if ((da[0] > 0 && da[1] > 0 && da[2] > 0) || (da[0] < 0 && da[1] < 0 && da[2] < 0)) return false;
+
+    // Plane of a against the vertices of b.
+    Point<T, 3> na = cross_product(a.vertices[1] - a.vertices[0], a.vertices[2] - a.vertices[0]);
+    T eps_a = tolerance * norm(na);
+    T db[3];
+    for (size_t i = 0; i < 3; ++i) {
+        db[i] = dot_product(na, b.vertices[i] - a.vertices[0]);
+        if (std::abs(db[i]) <= eps_a) db[i] = 0;
+    }
+    if ((db[0] > 0 && db[1] > 0 && db[2] > 0) || (db[0] < 0 && db[1] < 0 && db[2] < 0)) return false;
+
+    if ((da[0] == 0 && da[1] == 0 && da[2] == 0) || (db[0] == 0 && db[1] == 0 && db[2] == 0)) {
+        return coplanar_triangles_intersect(a, b, na);
+    }
+
+    // Project onto the dominant axis of the intersection line's direction.
+    const size_t axis = dominant_axis(cross_product(na, nb));
+    T pa[3], pb[3];
+    for (size_t i = 0; i < 3; ++i) {
+        pa[i] = a.vertices[i][axis];
+        pb[i] = b.vertices[i][axis];
+    }
+
+    std::pair<T, T> interval_a = triangle_interval(pa, da);
+    std::pair<T, T> interval_b = triangle_interval(pb, db);
+    return !(interval_a.second < interval_b.first || interval_b.second < interval_a.first);
+}
+
+/**
+ * @brief Determines if a segment and a triangle in 3D space intersect
+ * (touching counts). A segment crossing the triangle's plane is tested with
+ * Moller-Trumbore barycentric coordinates of the crossing point; a segment in
+ * the plane is tested in 2D. Degenerate triangles have no area and are never hit.
+ * @param segment The segment
+ * @param triangle The triangle
+ * @param tolerance Distance below which an endpoint is considered on the plane,
+ *                  and allowed negative barycentric coordinate
+ * @return true if the segment and the triangle intersect, false otherwise
+ */
+template <typename T>
+bool do_intersect(const LineSegment<T, 3>& segment, const Simplex<T, 3>& triangle, T tolerance = 1e-9) {
+    const Point<T, 3>& v0 = triangle.vertices[0];
+    Point<T, 3> e1 = triangle.vertices[1] - v0;
+    Point<T, 3> e2 = triangle.vertices[2] - v0;
+    Point<T, 3> normal = cross_product(e1, e2);
+    if (squared_norm(normal) == 0) return false;
+    T eps = tolerance * norm(normal);
+
+    Point<T, 3> offset = segment.start() - v0;
+    T d0 = dot_product(normal, offset);
+    T d1 = dot_product(normal, segment.end() - v0);
+    if (std::abs(d0) <= eps) d0 = 0;
+    if (std::abs(d1) <= eps) d1 = 0;
+    if ((d0 > 0 && d1 > 0) || (d0 < 0 && d1 < 0)) return false;
+
+    if (d0 == 0 && d1 == 0) {
+        const size_t drop = dominant_axis(normal);
+        const size_t u = (drop + 1) % 3;
+        const size_t v = (drop + 2) % 3;
+        auto project = [u, v](const Point<T, 3>& p) { return Point<T, 2>(p[u], p[v]); };
+        Point<T, 2> tri[3];
+        for (size_t i = 0; i < 3; ++i) {
+            tri[i] = project(triangle.vertices[i]);
+        }
+        LineSegment<T, 2> flat(project(segment.start()), project(segment.end()));
+        for (size_t i = 0; i < 3; ++i) {
+            if (do_intersect(flat, LineSegment<T, 2>(tri[i], tri[(i + 1) % 3]))) return true;
+        }
+        return triangle_contains(tri, flat.start());
+    }
+
+    // The segment straddles the plane, so the crossing is within it and
+    // det = d0 - d1 is non-zero.
+    Point<T, 3> direction = segment.end() - segment.start();
+    Point<T, 3> p = cross_product(direction, e2);
+    T inverse_det = T(1) / dot_product(e1, p);
+    T b1 = dot_product(offset, p) * inverse_det;
+    if (b1 < -tolerance || b1 > 1 + tolerance) return false;
+    T b2 = dot_product(direction, cross_product(offset, e1)) * inverse_det;
+    return b2 >= -tolerance && b1 + b2 <= 1 + tolerance;
+}
+
+} // namespace geometry
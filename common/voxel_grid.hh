@@ -0,0 +1,418 @@
+// Author: HW
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/bounding_box.hh"
+#include "common/line_segment.hh"
+#include "common/parallel_runs.hh"
+#include "common/point.hh"
+#include "common/surface.hh"
+#include "common/triangle_intersection.hh"
+
+namespace geometry {
+
+/**
+ * @brief Separating axis test between a triangle and an axis-aligned box
+ * (Akenine-Moller): the box's three axes, the triangle's normal and the nine
+ * cross products of box axes and triangle edges.
+ * @param center Center of the box
+ * @param half Half extents of the box
+ * @param triangle The triangle
+ * @return true if the triangle and the box overlap (touching counts)
+ */
+template <typename T>
+bool triangle_box_overlap(const Point<T, 3>& center, const Point<T, 3>& half, const Simplex<T, 3>& triangle) {
+    const Point<T, 3> v[3] = {triangle.vertices[0] - center, triangle.vertices[1] - center,
+                              triangle.vertices[2] - center};
+    const Point<T, 3> edges[3] = {v[1] - v[0], v[2] - v[1], v[0] - v[2]};
+
+    // Does the projection of the triangle onto axis miss [-r, r]?
+    auto separated = [&](const Point<T, 3>& axis) {
+        T p0 = dot_product(axis, v[0]);
+        T p1 = dot_product(axis, v[1]);
+        T p2 = dot_product(axis, v[2]);
+        T r = half[0] * std::abs(axis[0]) + half[1] * std::abs(axis[1]) + half[2] * std::abs(axis[2]);
+        return std::min({p0, p1, p2}) > r || std::max({p0, p1, p2}) < -r;
+    };
+
+    for (size_t i = 0; i < 3; ++i) {
+        if (std::min({v[0][i], v[1][i], v[2][i]}) > half[i] ||
+            std::max({v[0][i], v[1][i], v[2][i]}) < -half[i]) {
+            return false;
+        }
+    }
+    if (separated(cross_product(edges[0], edges[1]))) return false;
+    for (size_t i = 0; i < 3; ++i) {
+        Point<T, 3> unit;
+        unit[i] = 1;
+        for (size_t j = 0; j < 3; ++j) {
+            if (separated(cross_product(unit, edges[j]))) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sparse occupancy grid over the facets of a triangle mesh.
+ *
+ * Space is divided into cubic voxels, grouped into bricks of 8x8x8. Only
+ * bricks touched by the surface are stored, each as a 512-bit occupancy mask
+ * in a hash map. The facets overlapping each occupied voxel are listed in one
+ * shared array; a voxel's list is found from the rank of its bit in the mask.
+ *
+ * Voxelization is conservative: every facet is listed in every voxel it
+ * touches, slightly inflated. Segment queries walk the voxels along the
+ * segment with a 3D DDA (Amanatides-Woo) and run the exact segment/triangle
+ * test only on the facets of occupied voxels, so their cost depends on the
+ * segment's length in voxels rather than on the size of the mesh.
+ */
+template <typename T>
+class VoxelGrid {
+public:
+    /**
+     * @brief Voxelizes a surface.
+     * @param surface The triangle mesh
+     * @param voxel_size Edge length of a voxel
+     * @param executor Pool and number of threads for voxelization
+     * @param resource Where the bricks and facet lists are allocated; bricks
+     *                 are hash table nodes of about 100 bytes, which a
+     *                 FixedSizePool of 128-byte blocks serves
+     * @throws std::invalid_argument if voxel_size is not positive or too small for the mesh's extent
+     */
+    VoxelGrid(const Surface<T, 3>& surface, T voxel_size,
+              Executor executor = Executor(),
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : surface_(&surface), voxel_size_(voxel_size), bricks_(resource), voxel_offsets_(resource),
+          voxel_facets_(resource) {
+        if (!(voxel_size > 0)) {
+            throw std::invalid_argument("Voxel size must be positive");
+        }
+        inverse_voxel_size_ = T(1) / voxel_size;
+
+        BoundingBox<T, 3> bounds;
+        for (const Simplex<T, 3>& facet : surface.facets) {
+            for (const Point<T, 3>& vertex : facet.vertices) {
+                bounds.expand(vertex);
+            }
+        }
+        if (bounds.is_empty()) return;
+
+        // One empty voxel of padding on every side keeps the surface clear of
+        // the grid boundary, where segments are clipped.
+        origin_ = bounds.min();
+        for (size_t i = 0; i < 3; ++i) {
+            origin_[i] -= voxel_size;
+            T cells = std::floor(bounds.extent(i) * inverse_voxel_size_) + 3;
+            if (!(cells < static_cast<T>(kMaxVoxels))) {
+                throw std::invalid_argument("Voxel size is too small for the extent of the surface");
+            }
+            dims_[i] = static_cast<int64_t>(cells);
+        }
+
+        // Voxelize runs of facets in parallel into (voxel key, facet) entries,
+        // sorted per run and then merged.
+        const size_t n = surface.facets.size();
+        const size_t num_threads = std::max<size_t>(1, std::min(executor.num_threads(), n));
+        std::vector<std::vector<Entry>> runs(num_threads);
+        auto voxelize = [&](size_t run, size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                voxelize_facet(static_cast<uint32_t>(f), runs[run]);
+            }
+            std::sort(runs[run].begin(), runs[run].end());
+        };
+        size_t chunk = (n + num_threads - 1) / num_threads;
+        executor.pool().run(num_threads, [&](size_t run) {
+            voxelize(run, std::min(n, run * chunk), std::min(n, (run + 1) * chunk));
+        });
+
+        std::vector<Entry> entries = std::move(runs[0]);
+        for (size_t run = 1; run < num_threads; ++run) {
+            size_t middle = entries.size();
+            entries.insert(entries.end(), runs[run].begin(), runs[run].end());
+            std::inplace_merge(entries.begin(), entries.begin() + middle, entries.end());
+            std::vector<Entry>().swap(runs[run]);
+        }
+
+        // Bricks, masks and facet lists from the sorted entries.
+        voxel_offsets_.push_back(0);
+        voxel_facets_.reserve(entries.size());
+        uint64_t previous_voxel = std::numeric_limits<uint64_t>::max();
+        Brick* brick = nullptr;
+        for (const Entry& entry : entries) {
+            uint64_t voxel = entry.first;
+            if (voxel != previous_voxel) {
+                if (brick != nullptr) voxel_offsets_.push_back(static_cast<uint32_t>(voxel_facets_.size()));
+                uint64_t key = voxel >> kBrickBits;
+                if (brick == nullptr || key != (previous_voxel >> kBrickBits)) {
+                    brick = &bricks_[key];
+                    brick->first_voxel = static_cast<uint32_t>(voxel_offsets_.size() - 1);
+                }
+                uint32_t local = static_cast<uint32_t>(voxel & (kBrickVoxels - 1));
+                brick->mask[local / 64] |= uint64_t(1) << (local % 64);
+                previous_voxel = voxel;
+            }
+            voxel_facets_.push_back(entry.second);
+        }
+        if (!entries.empty()) voxel_offsets_.push_back(static_cast<uint32_t>(voxel_facets_.size()));
+    }
+
+    T voxel_size() const { return voxel_size_; }
+
+    size_t num_bricks() const { return bricks_.size(); }
+
+    size_t num_occupied_voxels() const { return voxel_offsets_.empty() ? 0 : voxel_offsets_.size() - 1; }
+
+    /**
+     * @brief Checks if the voxel containing a point is occupied.
+     */
+    bool is_occupied(const Point<T, 3>& p) const {
+        std::array<int64_t, 3> voxel;
+        for (size_t i = 0; i < 3; ++i) {
+            T offset = std::floor((p[i] - origin_[i]) * inverse_voxel_size_);
+            if (!(offset >= 0 && offset < static_cast<T>(dims_[i]))) return false;
+            voxel[i] = static_cast<int64_t>(offset);
+        }
+        const Brick* brick = find_brick(brick_key(voxel));
+        return brick != nullptr && occupied(*brick, local_index(voxel));
+    }
+
+    /**
+     * @brief Checks if a segment intersects any facet of the surface.
+     * @param segment The segment
+     * @param tolerance Tolerance of the segment/triangle test
+     * @return true if the segment touches the surface
+     */
+    bool do_intersect(const LineSegment<T, 3>& segment, T tolerance = 1e-9) const {
+        bool hit = false;
+        walk(segment, [&](const uint32_t* begin, const uint32_t* end) {
+            for (const uint32_t* f = begin; f != end; ++f) {
+                if (geometry::do_intersect(segment, surface_->facets[*f], tolerance)) {
+                    hit = true;
+                    return true;
+                }
+            }
+            return false;
+        });
+        return hit;
+    }
+
+    /**
+     * @brief Checks many segments against the surface. Each thread handles a
+     * contiguous run of the segments.
+     * @param segments The segments
+     * @param executor Pool and number of threads
+     * @param tolerance Tolerance of the segment/triangle test
+     * @return For each segment, 1 if it touches the surface and 0 otherwise
+     */
+    std::vector<uint8_t> do_intersect(const std::vector<LineSegment<T, 3>>& segments,
+                                      Executor executor = Executor(),
+                                      T tolerance = 1e-9) const {
+        std::vector<uint8_t> result(segments.size());
+        auto run = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                result[i] = do_intersect(segments[i], tolerance) ? 1 : 0;
+            }
+        };
+        for_each_run(segments.size(), executor, run);
+        return result;
+    }
+
+    /**
+     * @brief Finds all facets a segment intersects.
+     * @param segment The segment
+     * @param tolerance Tolerance of the segment/triangle test
+     * @return Indices of the intersected facets, sorted
+     */
+    std::vector<uint32_t> intersected_facets(const LineSegment<T, 3>& segment, T tolerance = 1e-9) const {
+        std::vector<uint32_t> candidates;
+        walk(segment, [&](const uint32_t* begin, const uint32_t* end) {
+            candidates.insert(candidates.end(), begin, end);
+            return false;
+        });
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        std::vector<uint32_t> result;
+        for (uint32_t f : candidates) {
+            if (geometry::do_intersect(segment, surface_->facets[f], tolerance)) result.push_back(f);
+        }
+        return result;
+    }
+
+private:
+    // Voxels per brick along each axis is 1 << kBrickShift.
+    static constexpr int kBrickShift = 3;
+    static constexpr int kBrickBits = 3 * kBrickShift;
+    static constexpr uint32_t kBrickVoxels = 1u << kBrickBits;
+    // Voxels per axis, so that brick coordinates pack into 54 bits.
+    static constexpr int64_t kMaxVoxels = int64_t(1) << 21;
+    static constexpr int kKeyBits = 21 - kBrickShift;
+    // Relative growth of voxels during voxelization.
+    static constexpr T kInflation = T(1) / 1024;
+
+    struct Brick {
+        std::array<uint64_t, kBrickVoxels / 64> mask{};
+        // Index of the brick's first occupied voxel in voxel_offsets_.
+        uint32_t first_voxel = 0;
+    };
+
+    // (brick key << kBrickBits | local index, facet)
+    using Entry = std::pair<uint64_t, uint32_t>;
+
+    const Surface<T, 3>* surface_;
+    T voxel_size_;
+    T inverse_voxel_size_;
+    Point<T, 3> origin_;
+    std::array<int64_t, 3> dims_{};
+    std::pmr::unordered_map<uint64_t, Brick> bricks_;
+    std::pmr::vector<uint32_t> voxel_offsets_;
+    std::pmr::vector<uint32_t> voxel_facets_;
+
+    static uint64_t brick_key(const std::array<int64_t, 3>& voxel) {
+        return uint64_t(voxel[0] >> kBrickShift) | (uint64_t(voxel[1] >> kBrickShift) << kKeyBits) |
+               (uint64_t(voxel[2] >> kBrickShift) << (2 * kKeyBits));
+    }
+
+    static uint32_t local_index(const std::array<int64_t, 3>& voxel) {
+        constexpr int64_t mask = (1 << kBrickShift) - 1;
+        return static_cast<uint32_t>((voxel[0] & mask) | ((voxel[1] & mask) << kBrickShift) |
+                                     ((voxel[2] & mask) << (2 * kBrickShift)));
+    }
+
+    static bool occupied(const Brick& brick, uint32_t local) {
+        return (brick.mask[local / 64] >> (local % 64)) & 1;
+    }
+
+    const Brick* find_brick(uint64_t key) const {
+        auto it = bricks_.find(key);
+        return it == bricks_.end() ? nullptr : &it->second;
+    }
+
+    // Index of an occupied voxel in voxel_offsets_: the brick's first voxel
+    // plus the number of occupied voxels before it in the mask.
+    static uint32_t voxel_slot(const Brick& brick, uint32_t local) {
+        uint32_t rank = 0;
+        for (uint32_t word = 0; word < local / 64; ++word) {
+            rank += __builtin_popcountll(brick.mask[word]);
+        }
+        uint64_t below = brick.mask[local / 64] & ((uint64_t(1) << (local % 64)) - 1);
+        return brick.first_voxel + rank + __builtin_popcountll(below);
+    }
+
+    void voxelize_facet(uint32_t f, std::vector<Entry>& entries) const {
+        const Simplex<T, 3>& facet = surface_->facets[f];
+        std::array<int64_t, 3> low, high;
+        for (size_t i = 0; i < 3; ++i) {
+            T lo = std::min({facet.vertices[0][i], facet.vertices[1][i], facet.vertices[2][i]});
+            T hi = std::max({facet.vertices[0][i], facet.vertices[1][i], facet.vertices[2][i]});
+            low[i] = std::max<int64_t>(0, static_cast<int64_t>(std::floor((lo - origin_[i]) * inverse_voxel_size_)) - 1);
+            high[i] = std::min<int64_t>(dims_[i] - 1,
+                                        static_cast<int64_t>(std::floor((hi - origin_[i]) * inverse_voxel_size_)) + 1);
+        }
+
+        // Voxels are inflated so that rounding in the DDA cannot miss a facet.
+        const T half_size = voxel_size_ * T(0.5) * (1 + kInflation);
+        const Point<T, 3> half(half_size, half_size, half_size);
+        std::array<int64_t, 3> voxel;
+        for (voxel[2] = low[2]; voxel[2] <= high[2]; ++voxel[2]) {
+            for (voxel[1] = low[1]; voxel[1] <= high[1]; ++voxel[1]) {
+                for (voxel[0] = low[0]; voxel[0] <= high[0]; ++voxel[0]) {
+                    Point<T, 3> center;
+                    for (size_t i = 0; i < 3; ++i) {
+                        center[i] = origin_[i] + (static_cast<T>(voxel[i]) + T(0.5)) * voxel_size_;
+                    }
+                    if (triangle_box_overlap(center, half, facet)) {
+                        entries.emplace_back((brick_key(voxel) << kBrickBits) | local_index(voxel), f);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Calls visit(begin, end) with the facet list of each occupied
+     * voxel the segment passes through, in order along the segment, until
+     * visit returns true.
+     */
+    template <typename Visit>
+    void walk(const LineSegment<T, 3>& segment, Visit visit) const {
+        if (bricks_.empty()) return;
+
+        // The segment in voxel units, clipped to the grid.
+        T a[3], d[3];
+        T t0 = 0, t1 = 1;
+        for (size_t i = 0; i < 3; ++i) {
+            a[i] = (segment.start()[i] - origin_[i]) * inverse_voxel_size_;
+            d[i] = (segment.end()[i] - segment.start()[i]) * inverse_voxel_size_;
+            T extent = static_cast<T>(dims_[i]);
+            if (d[i] == 0) {
+                if (a[i] < 0 || a[i] > extent) return;
+                continue;
+            }
+            T enter = -a[i] / d[i];
+            T exit = (extent - a[i]) / d[i];
+            if (enter > exit) std::swap(enter, exit);
+            t0 = std::max(t0, enter);
+            t1 = std::min(t1, exit);
+        }
+        if (t0 > t1) return;
+
+        std::array<int64_t, 3> voxel;
+        int64_t step[3];
+        T next[3], delta[3];
+        for (size_t i = 0; i < 3; ++i) {
+            T x = a[i] + d[i] * t0;
+            voxel[i] = std::clamp<int64_t>(static_cast<int64_t>(std::floor(x)), 0, dims_[i] - 1);
+            step[i] = d[i] > 0 ? 1 : (d[i] < 0 ? -1 : 0);
+            if (d[i] == 0) {
+                next[i] = delta[i] = std::numeric_limits<T>::infinity();
+            } else {
+                T boundary = static_cast<T>(voxel[i] + (d[i] > 0 ? 1 : 0));
+                next[i] = (boundary - a[i]) / d[i];
+                delta[i] = std::abs(T(1) / d[i]);
+            }
+        }
+
+        // The brick of the previous step is usually the brick of this one.
+        uint64_t cached_key = std::numeric_limits<uint64_t>::max();
+        const Brick* brick = nullptr;
+        while (true) {
+            uint64_t key = brick_key(voxel);
+            if (key != cached_key) {
+                cached_key = key;
+                brick = find_brick(key);
+            }
+            if (brick != nullptr) {
+                uint32_t local = local_index(voxel);
+                if (occupied(*brick, local)) {
+                    uint32_t slot = voxel_slot(*brick, local);
+                    if (visit(voxel_facets_.data() + voxel_offsets_[slot],
+                              voxel_facets_.data() + voxel_offsets_[slot + 1])) {
+                        return;
+                    }
+                }
+            }
+
+            size_t axis = 0;
+            if (next[1] < next[axis]) axis = 1;
+            if (next[2] < next[axis]) axis = 2;
+            if (next[axis] > t1) return;
+            voxel[axis] += step[axis];
+            if (voxel[axis] < 0 || voxel[axis] >= dims_[axis]) return;
+            next[axis] += delta[axis];
+        }
+    }
+};
+
+} // namespace geometry
@@ -0,0 +1,59 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "test_meshes.hh"
+#include "voxel_grid.hh"
+
+int main() {
+    using namespace geometry;
+
+    // Test case 1: Segment/triangle
+    Simplex<double, 3> triangle({Point<double, 3>(0, 0, 0), Point<double, 3>(2, 0, 0), Point<double, 3>(0, 2, 0)});
+    LineSegment<double, 3> piercing(Point<double, 3>(0.5, 0.5, -1), Point<double, 3>(0.5, 0.5, 1));
+    LineSegment<double, 3> missing(Point<double, 3>(2, 2, -1), Point<double, 3>(2, 2, 1));
+    LineSegment<double, 3> short_of(Point<double, 3>(0.5, 0.5, 2), Point<double, 3>(0.5, 0.5, 1));
+    LineSegment<double, 3> in_plane(Point<double, 3>(-1, 1, 0), Point<double, 3>(3, 1, 0));
+    std::cout << "Test 1 - Segment/triangle:" << std::endl;
+    std::cout << "Piercing segment intersects? " << (do_intersect(piercing, triangle) ? "Yes" : "No") << std::endl;
+    std::cout << "Segment beside the triangle intersects? " << (do_intersect(missing, triangle) ? "Yes" : "No") << std::endl;
+    std::cout << "Segment ending above the triangle intersects? " << (do_intersect(short_of, triangle) ? "Yes" : "No") << std::endl;
+    std::cout << "Segment crossing in the plane intersects? " << (do_intersect(in_plane, triangle) ? "Yes" : "No") << std::endl;
+    std::cout << std::endl;
+
+    // Test case 2: Random segments against a voxelized sphere and brute force
+    Surface<double, 3> surface = triangulated_sphere(Point<double, 3>(0.1, -0.2, 0.3), 1.0, 32, 64);
+    VoxelGrid<double> grid(surface, 0.05, 4);
+    std::cout << "Test 2 - Voxel grid:" << std::endl;
+    std::cout << surface << ": " << grid.num_occupied_voxels() << " occupied voxels in "
+              << grid.num_bricks() << " bricks" << std::endl;
+    std::cout << "Center occupied? " << (grid.is_occupied(Point<double, 3>(0.1, -0.2, 0.3)) ? "Yes" : "No") << std::endl;
+    std::cout << "Surface occupied? " << (grid.is_occupied(surface.facets[100].centroid()) ? "Yes" : "No") << std::endl;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coordinate(-1.5, 1.5);
+    std::uniform_real_distribution<double> offset(-0.3, 0.3);
+    std::vector<LineSegment<double, 3>> segments;
+    for (int i = 0; i < 2000; ++i) {
+        Point<double, 3> start(coordinate(rng), coordinate(rng), coordinate(rng));
+        Point<double, 3> end(start.x() + offset(rng), start.y() + offset(rng), start.z() + offset(rng));
+        segments.emplace_back(start, end);
+    }
+    // Segments along grid lines and through facet vertices.
+    segments.emplace_back(Point<double, 3>(-2, 0, 0), Point<double, 3>(2, 0, 0));
+    segments.emplace_back(surface.facets[5].vertices[1], surface.facets[5].vertices[1] + Point<double, 3>(0.01, 0, 0));
+
+    std::vector<uint8_t> hits = grid.do_intersect(segments, 4);
+    size_t num_hits = 0, mismatches = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        std::vector<uint32_t> expected;
+        for (uint32_t f = 0; f < surface.num_facets(); ++f) {
+            if (do_intersect(segments[i], surface.facets[f])) expected.push_back(f);
+        }
+        if (grid.intersected_facets(segments[i]) != expected || hits[i] != !expected.empty()) ++mismatches;
+        num_hits += hits[i];
+    }
+    std::cout << "Segments hitting the surface: " << num_hits << " of " << segments.size() << std::endl;
+    std::cout << "Matches brute force? " << (mismatches == 0 ? "Yes" : "No") << std::endl;
+
+    return 0;
+}